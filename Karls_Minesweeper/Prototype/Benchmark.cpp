@@ -0,0 +1,589 @@
+
+#include "Benchmark.h"
+#include "BitboardSweep.h"
+#include "BoardLayout.h"
+#include "ConcurrentBoard.h"
+#include "FixedBoard.h"
+#include "GameSession.h"
+#include "ProbabilityMap.h"
+#include "ScanlineSweep.h"
+#include "Topology.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace kms
+{
+	namespace
+	{
+		const unsigned clicks_per_game = 16;
+
+		struct BenchmarkResult
+		{
+			double per_second = 0;
+			double tiles_per_iteration = 0;	// printed so the work cannot be optimized away, and equal for paths doing the same work
+			std::uint64_t iterations = 0;
+		};
+
+		// Last level cache misses and data TLB read misses of this thread, counted through perf events on Linux.
+		// Elsewhere, or when the kernel does not permit perf events, Available() is false and the benchmark measures time only.
+		class MissCounters
+		{
+		public:
+			enum ECounter { cache_misses, tlb_misses, counter_count };
+
+			MissCounters()
+			{
+#if defined(__linux__)
+				const std::uint64_t configs[counter_count][2] = {
+					{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+					{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) } };
+
+				for (auto counter = 0; counter < counter_count; ++counter)
+				{
+					perf_event_attr attributes{};
+					attributes.size = sizeof(attributes);
+					attributes.type = static_cast<std::uint32_t>(configs[counter][0]);
+					attributes.config = configs[counter][1];
+					attributes.disabled = 1;
+					attributes.exclude_kernel = 1;
+					attributes.exclude_hv = 1;
+					fds_[counter] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+				}
+#endif
+			}
+
+			~MissCounters()
+			{
+#if defined(__linux__)
+				for (auto fd : fds_)
+					if (fd >= 0)
+						close(fd);
+#endif
+			}
+
+			MissCounters(const MissCounters&) = delete;
+			MissCounters& operator=(const MissCounters&) = delete;
+
+			bool Available() const { return fds_[cache_misses] >= 0 && fds_[tlb_misses] >= 0; }
+
+			void Start()
+			{
+#if defined(__linux__)
+				for (auto fd : fds_)
+				{
+					ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+					ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+				}
+#endif
+			}
+
+			// Misses since Start
+			std::array<std::uint64_t, counter_count> Stop()
+			{
+				std::array<std::uint64_t, counter_count> counts{};
+#if defined(__linux__)
+				for (auto counter = 0; counter < counter_count; ++counter)
+				{
+					ioctl(fds_[counter], PERF_EVENT_IOC_DISABLE, 0);
+					if (read(fds_[counter], &counts[counter], sizeof(counts[counter])) != sizeof(counts[counter]))
+						counts[counter] = 0;
+				}
+#endif
+				return counts;
+			}
+
+		private:
+			int fds_[counter_count] = { -1, -1 };
+		};
+
+		// Run fn_iteration(i) batch times at a time until at least the minimum time has passed, fn_iteration returns the tiles it revealed
+		template<class T_Fn>
+		BenchmarkResult Measure(T_Fn fn_iteration, unsigned batch = 64)
+		{
+			const auto minimum_time = std::chrono::milliseconds(300);
+
+			BenchmarkResult result;
+			std::uint64_t iterations = 0;
+			std::uint64_t tiles = 0;
+			const auto begin = std::chrono::steady_clock::now();
+			auto elapsed = std::chrono::steady_clock::duration{};
+
+			do
+			{
+				for (auto i = 0u; i < batch; ++i)
+					tiles += fn_iteration(iterations++);
+				elapsed = std::chrono::steady_clock::now() - begin;
+			} while (elapsed < minimum_time);
+
+			result.per_second = iterations / std::chrono::duration<double>(elapsed).count();
+			result.tiles_per_iteration = static_cast<double>(tiles) / iterations;
+			result.iterations = iterations;
+			return result;
+		}
+
+		// Same click sequence for every path playing game number game_index
+		Pos2D ClickPosition(std::uint64_t game_index, unsigned click, const Size2D& board_size)
+		{
+			const auto hash = MineHash(game_index, Position2D(click, 0xC11C));
+			return Position2D(static_cast<unsigned>(hash % board_size.width), static_cast<unsigned>((hash >> 32) % board_size.height));
+		}
+
+		std::uint64_t PlayRuntimeGame(const Size2D& board_size, unsigned coverage, std::uint64_t game_index, EBoardGeneration generation = EBoardGeneration::eager)
+		{
+			GameSession session(std::make_shared<const Board>(board_size, coverage, game_index, generation));
+
+			std::uint64_t revealed = 0;
+			for (auto click = 0u; click < clicks_per_game && !session.IsGameOver(); ++click)
+			{
+				for (const auto& span : session.Reveal(ClickPosition(game_index, click, board_size)).cleared)
+					revealed += span.range.end - span.range.begin;
+			}
+			return revealed;
+		}
+
+		template<class T_Board>
+		std::uint64_t PlayFixedGame(unsigned coverage, std::uint64_t game_index)
+		{
+			T_Board board;
+			board.Generate(coverage, game_index);
+
+			typename T_Board::Bitboard_t revealed;
+			std::uint64_t revealed_count = 0;
+			for (auto click = 0u; click < clicks_per_game; ++click)
+			{
+				const auto position = ClickPosition(game_index, click, T_Board::BoardSize());
+				const auto newly_revealed = board.Reveal(revealed, position);
+
+				for (auto word : newly_revealed.words)
+					for (; word; word &= word - 1)
+						++revealed_count;
+
+				if (board.Mines().Test(T_Board::OffsetIndex(position)))
+					break;
+			}
+			return revealed_count;
+		}
+
+		void PrintResult(std::ostream& out, const char* name, const BenchmarkResult& result, const char* unit)
+		{
+			out << "  " << std::left << std::setw(36) << name << std::right << std::setw(14) << std::fixed << std::setprecision(0)
+				<< result.per_second << ' ' << unit << std::setprecision(2) << "   (" << result.tiles_per_iteration << " tiles revealed each)\n";
+		}
+
+		template<class T_Board>
+		void BenchmarkPreset(std::ostream& out, const char* name, unsigned coverage)
+		{
+			out << name << ' ' << T_Board::width << 'x' << T_Board::height << ", " << coverage << "% mines\n";
+
+			const auto runtime = Measure([&](std::uint64_t i) { return PlayRuntimeGame(T_Board::BoardSize(), coverage, i); });
+			const auto fixed = Measure([&](std::uint64_t i) { return PlayFixedGame<T_Board>(coverage, i); });
+
+			PrintResult(out, "Board + GameSession + ScanlineSweep", runtime, "games/s");
+			PrintResult(out, "FixedBoard bitboard reveal", fixed, "games/s");
+			out << "  speedup " << std::setprecision(1) << fixed.per_second / runtime.per_second << "x\n";
+		}
+
+		// Sweeps on one board from a handful of blank start tiles, the cleared state is reset between sweeps by bumping a stamp
+		struct SweepFixture
+		{
+			SweepFixture(const Size2D& size, TilesVector_t board_tiles)
+				: board_size(size)
+				, tiles(std::move(board_tiles))
+				, cleared_stamps(tiles.size(), 0)
+			{
+				for (auto i = 0u; start_positions.size() < 8 && i < 1024; ++i)
+				{
+					const auto position = ClickPosition(i, 0, board_size);
+					if (tiles[GetOffsetIndex(board_size, position)] == 0)
+						start_positions.push_back(position);
+				}
+				if (start_positions.empty())
+					start_positions.push_back(Position2D(0, 0));
+			}
+
+			std::function<int(Pos2D)> GetTileData() const
+			{
+				return [this](Pos2D position) { return tiles[position.y * board_size.width + position.x]; };
+			}
+
+			std::function<bool(Pos2D)> ClearTile(std::uint64_t& cleared_count)
+			{
+				return [this, &cleared_count](Pos2D position) {
+					auto& stamp = cleared_stamps[position.y * board_size.width + position.x];
+					if (stamp == current_stamp)
+						return false;
+					stamp = current_stamp;
+					++cleared_count;
+					return true;
+				};
+			}
+
+			Pos2D NextStart(std::uint64_t iteration)
+			{
+				++current_stamp;
+				return start_positions[iteration % start_positions.size()];
+			}
+
+			Size2D board_size;
+			TilesVector_t tiles;
+			std::vector<std::uint32_t> cleared_stamps;
+			std::uint32_t current_stamp = 0;
+			std::vector<Pos2D> start_positions;
+		};
+
+		void BenchmarkSweepBackends(std::ostream& out, const Size2D& board_size, unsigned coverage)
+		{
+			out << board_size.width << 'x' << board_size.height << ", " << coverage << "% mines\n";
+
+			SweepFixture fixture(board_size, PlaceMines(board_size, coverage, 42));
+			const auto fn_get_tile_data = fixture.GetTileData();
+			const auto sweeper = BitboardSweeper(board_size, fn_get_tile_data);
+
+			const auto scanline = Measure([&](std::uint64_t i) {
+				std::uint64_t cleared = 0;
+				ScanlineSweep(board_size, fixture.NextStart(i), fn_get_tile_data, fixture.ClearTile(cleared));
+				return cleared;
+			});
+
+			BitboardWorkspace workspace;
+			const auto bitboard = Measure([&](std::uint64_t i) {
+				std::uint64_t cleared = 0;
+				sweeper.Sweep(fixture.NextStart(i), fixture.ClearTile(cleared), workspace);
+				return cleared;
+			});
+
+			const auto bitboard_drop_in = Measure([&](std::uint64_t i) {
+				std::uint64_t cleared = 0;
+				BitboardSweep(board_size, fixture.NextStart(i), fn_get_tile_data, fixture.ClearTile(cleared));
+				return cleared;
+			});
+
+			PrintResult(out, "ScanlineSweep", scanline, "sweeps/s");
+			PrintResult(out, "BitboardSweeper, blank mask kept", bitboard, "sweeps/s");
+			PrintResult(out, "BitboardSweep, mask built per sweep", bitboard_drop_in, "sweeps/s");
+		}
+
+		// Measure with the cache and TLB misses per iteration appended, when the platform can count them
+		template<class T_Fn>
+		void MeasureMisses(std::ostream& out, const char* name, const char* unit, T_Fn fn_iteration, unsigned batch)
+		{
+			MissCounters counters;
+			counters.Start();
+			const auto result = Measure(fn_iteration, batch);
+			const auto misses = counters.Stop();
+
+			PrintResult(out, name, result, unit);
+			if (counters.Available())
+			{
+				out << "  " << std::setw(36) << "" << std::setprecision(0)
+					<< std::setw(14) << static_cast<double>(misses[MissCounters::cache_misses]) / result.iterations << " cache misses, "
+					<< static_cast<double>(misses[MissCounters::tlb_misses]) / result.iterations << " dTLB misses each\n";
+			}
+		}
+
+		// ScanlineSweep from position with revealed indexed by the board's layout, returns the tiles revealed
+		template<class T_Layout>
+		std::uint64_t RevealOn(const BasicBoard<T_Layout>& board, TileBitmap& revealed, const Pos2D& position)
+		{
+			std::uint64_t revealed_count = 0;
+			ScanlineSweep(board.BoardSize(), position,
+				[&](Pos2D tile) { return board.TileAt(tile); },
+				[&](Pos2D tile) {
+					const auto offset = board.Offset(tile);
+					if (revealed.Test(offset))
+						return false;
+					revealed.Set(offset);
+					++revealed_count;
+					return true;
+				});
+
+			return revealed_count;
+		}
+
+		// Reset revealed and click the board in a fixed sequence, the way a game on a huge board walks around
+		template<class T_Layout>
+		std::uint64_t PlayLayoutGame(const BasicBoard<T_Layout>& board, TileBitmap& revealed, std::uint64_t game_index)
+		{
+			const unsigned clicks_per_layout_game = 256;
+
+			revealed.Assign(0, revealed.Size(), false);
+
+			std::uint64_t revealed_count = 0;
+			for (auto click = 0u; click < clicks_per_layout_game; ++click)
+				revealed_count += RevealOn(board, revealed, ClickPosition(game_index, click, board.BoardSize()));
+			return revealed_count;
+		}
+
+		template<class T_Layout>
+		void BenchmarkLayout(std::ostream& out, const char* name, const Size2D& board_size, unsigned coverage)
+		{
+			out << name << '\n';
+
+			MeasureMisses(out, "Board generation", "boards/s", [&](std::uint64_t i) {
+				return static_cast<std::uint64_t>(BasicBoard<T_Layout>(board_size, coverage, i).StorageSize());
+			}, 1);
+
+			const BasicBoard<T_Layout> board(board_size, coverage, 42);
+			TileBitmap revealed(board.StorageSize());
+			MeasureMisses(out, "Board reveal, 256 clicks", "games/s", [&](std::uint64_t i) {
+				return PlayLayoutGame(board, revealed, i);
+			}, 1);
+		}
+
+		// Play games by always revealing the safest looking tile, timing the ProbabilityMap update after every reveal
+		void BenchmarkHints(std::ostream& out, const Size2D& board_size, unsigned coverage, unsigned games)
+		{
+			const unsigned max_moves = 200;
+
+			auto latencies = std::vector<std::chrono::nanoseconds>{};
+			unsigned won = 0;
+			unsigned sampled = 0;
+
+			for (auto game = 0u; game < games; ++game)
+			{
+				GameSession session(std::make_shared<const Board>(board_size, coverage, game));
+				ProbabilityMap hints;
+				hints.Rebuild(session);
+
+				auto position = ClickPosition(game, 0, board_size);
+				for (auto move = 0u; move < max_moves && !session.IsGameOver(); ++move)
+				{
+					const auto result = session.Reveal(position);
+
+					const auto begin = std::chrono::steady_clock::now();
+					hints.Update(session, result);
+					latencies.push_back(std::chrono::steady_clock::now() - begin);
+					sampled += !hints.IsExact();
+
+					// next move on the hidden tile least likely to be a mine
+					const auto& probabilities = hints.Probabilities();
+					auto best = probabilities.size();
+					for (auto offset = 0u; offset < probabilities.size(); ++offset)
+						if (session.StateAt(Position2D(offset % board_size.width, offset / board_size.width)) != ETileState::revealed && (best == probabilities.size() || probabilities[offset] < probabilities[best]))
+							best = offset;
+
+					// only mines left hidden
+					if (best == probabilities.size() || probabilities[best] > 0.999999)
+						break;
+
+					position = Position2D(static_cast<unsigned>(best % board_size.width), static_cast<unsigned>(best / board_size.width));
+				}
+
+				won += !session.IsGameOver();
+			}
+
+			std::sort(latencies.begin(), latencies.end());
+			const auto fn_micros = [&](unsigned percent) {
+				return std::chrono::duration<double, std::micro>(latencies[(latencies.size() - 1) * percent / 100]).count();
+			};
+
+			out << board_size.width << 'x' << board_size.height << ", " << coverage << "% mines, " << games << " games, " << latencies.size() << " updates\n"
+				<< "  update p50 " << std::setprecision(0) << fn_micros(50) << " us, p99 " << fn_micros(99) << " us, max " << fn_micros(100) << " us\n"
+				<< "  " << won << " games not lost, " << sampled << " updates sampled instead of counted\n";
+		}
+
+		void BenchmarkGeneration(std::ostream& out, const Size2D& board_size, unsigned coverage)
+		{
+			out << board_size.width << 'x' << board_size.height << ", " << coverage << "% mines, " << clicks_per_game << " clicks per game\n";
+
+			const auto eager = Measure([&](std::uint64_t i) { return PlayRuntimeGame(board_size, coverage, i, EBoardGeneration::eager); }, 1);
+			const auto lazy = Measure([&](std::uint64_t i) { return PlayRuntimeGame(board_size, coverage, i, EBoardGeneration::lazy); }, 1);
+
+			PrintResult(out, "Eager board", eager, "games/s");
+			PrintResult(out, "Lazy board", lazy, "games/s");
+		}
+
+		// One long game kept whole in the history: what the history costs against copying the tile states every step,
+		// and how fast the game is undone and redone step by step
+		void BenchmarkHistory(std::ostream& out, const Size2D& board_size, unsigned coverage, unsigned action_count)
+		{
+			GameSession session(std::make_shared<const Board>(board_size, coverage, 42));
+
+			std::uint64_t revealed = 0;
+			for (auto action = 0u; action < action_count; ++action)
+			{
+				// flag the mines instead of stepping on them, so the game lasts every action
+				const auto position = ClickPosition(42, action, board_size);
+				if (session.TileAt(position) == mine_value)
+				{
+					session.ToggleFlag(position);
+					continue;
+				}
+
+				for (const auto& span : session.Reveal(position).cleared)
+					revealed += span.range.end - span.range.begin;
+			}
+
+			const auto& history = session.History();
+			const auto steps = history.StepCount();
+			const auto bitmap_bytes = 2.0 * session.GetBoard()->StorageSize() / 8;
+
+			out << board_size.width << 'x' << board_size.height << ", " << coverage << "% mines, " << action_count << " reveals and flags, "
+				<< steps << " steps, " << revealed << " tiles revealed\n"
+				<< "  history " << std::setprecision(1) << history.MemoryUsage() / 1024.0 << " KB, " << static_cast<double>(history.MemoryUsage()) / steps
+				<< " bytes per step, copying the tile states every step would take " << std::setprecision(0) << bitmap_bytes * steps / (1024 * 1024) << " MB\n";
+
+			const auto begin = std::chrono::steady_clock::now();
+			while (session.Undo())
+				;
+			while (session.Redo())
+				;
+			const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+			out << "  undo every step, then redo every step: " << std::setprecision(1) << elapsed / (2 * steps) << " us per step\n";
+		}
+
+		// Every thread clicks the same sequence, each starting at a different click, so the sweeps keep running into each other.
+		// Each tile must come back from exactly one reveal, and the reveals together must clear what they clear one after the other.
+		void CheckConcurrentReveals(std::ostream& out, const Size2D& board_size, unsigned coverage, unsigned thread_count, unsigned rounds)
+		{
+			const unsigned clicks = 32;
+
+			for (auto round = 0u; round < rounds; ++round)
+			{
+				const ConcurrentBoard board(std::make_shared<const Board>(board_size, coverage, round));
+
+				auto claimed = std::vector<std::vector<ClearedSpan>>(thread_count);
+				auto threads = std::vector<std::thread>{};
+				for (auto t = 0u; t < thread_count; ++t)
+				{
+					threads.emplace_back([&, t] {
+						SweepWorkspace workspace;
+						for (auto click = 0u; click < clicks; ++click)
+						{
+							const auto result = board.Reveal(ClickPosition(round, (click + t) % clicks, board_size), workspace);
+							claimed[t].insert(claimed[t].end(), result.cleared.begin(), result.cleared.end());
+						}
+					});
+				}
+				for (auto& thread : threads)
+					thread.join();
+
+				auto claims = std::vector<unsigned>(Size(board_size), 0);
+				for (const auto& spans : claimed)
+					for (const auto& span : spans)
+						for (auto x = span.range.begin; x < span.range.end; ++x)
+							++claims[GetOffsetIndex(board_size, Position2D(x, span.row))];
+
+				const auto& tiles = *board.GetBoard();
+				auto cleared = std::vector<std::uint8_t>(Size(board_size), 0);
+				for (auto click = 0u; click < clicks; ++click)
+				{
+					ScanlineSweep(board_size, ClickPosition(round, click, board_size),
+						[&](Pos2D position) { return tiles.TileAt(position); },
+						[&](Pos2D position) { return !std::exchange(cleared[GetOffsetIndex(board_size, position)], std::uint8_t{ 1 }); });
+				}
+
+				for (auto offset = 0u; offset < cleared.size(); ++offset)
+				{
+					const auto position = Position2D(offset % board_size.width, offset / board_size.width);
+					if (claims[offset] != cleared[offset] || board.IsCleared(position) != (cleared[offset] != 0))
+						throw(std::logic_error("Concurrent reveals cleared a tile twice or not at all!"));
+				}
+			}
+
+			out << "  " << rounds << " rounds of " << thread_count << " threads on " << board_size.width << 'x' << board_size.height
+				<< ": every tile claimed exactly once\n";
+		}
+
+		// The same clicks on one board, split over thread_count threads
+		void BenchmarkConcurrentReveals(std::ostream& out, const Size2D& board_size, unsigned coverage, unsigned thread_count)
+		{
+			const unsigned clicks = 64;
+
+			ConcurrentBoard board(std::make_shared<const Board>(board_size, coverage, 42));
+			const auto result = Measure([&](std::uint64_t i) {
+				board.Reset();
+
+				auto threads = std::vector<std::thread>{};
+				for (auto t = 0u; t < thread_count; ++t)
+				{
+					threads.emplace_back([&, t] {
+						SweepWorkspace workspace;
+						for (auto click = t; click < clicks; click += thread_count)
+							board.Reveal(ClickPosition(i, click, board_size), workspace);
+					});
+				}
+				for (auto& thread : threads)
+					thread.join();
+
+				return static_cast<std::uint64_t>(board.ClearedCount());
+			}, 1);
+
+			PrintResult(out, (std::to_string(thread_count) + (thread_count == 1 ? " thread" : " threads")).c_str(), result, "boards/s");
+		}
+
+		template<class T_Topology>
+		void BenchmarkTopology(std::ostream& out, const char* name, const Size2D& board_size, unsigned coverage)
+		{
+			const auto generate = Measure([&](std::uint64_t i) {
+				return static_cast<std::uint64_t>(PlaceMinesOn<T_Topology>(board_size, coverage, i).size());
+			});
+
+			SweepFixture fixture(board_size, PlaceMinesOn<T_Topology>(board_size, coverage, 42));
+			const auto fn_get_tile_data = fixture.GetTileData();
+			const auto sweep = Measure([&](std::uint64_t i) {
+				std::uint64_t cleared = 0;
+				TopologySweep<T_Topology>(board_size, fixture.NextStart(i), fn_get_tile_data, fixture.ClearTile(cleared));
+				return cleared;
+			});
+
+			out << name << '\n';
+			PrintResult(out, "PlaceMinesOn", generate, "boards/s");
+			PrintResult(out, "TopologySweep", sweep, "sweeps/s");
+		}
+	}
+
+	void RunBenchmarks(std::ostream& out)
+	{
+		out << "Classic presets, " << clicks_per_game << " clicks per game or until a mine is hit\n";
+		BenchmarkPreset<BeginnerBoard>(out, "Beginner", 12);
+		BenchmarkPreset<IntermediateBoard>(out, "Intermediate", 16);
+		BenchmarkPreset<ExpertBoard>(out, "Expert", 21);
+
+		out << "\nBoard generation\n";
+		BenchmarkGeneration(out, Size2D{ 4096, 4096 }, 21);
+
+		out << "\nUndo history\n";
+		BenchmarkHistory(out, Size2D{ 4096, 4096 }, 12, 5000);
+
+		out << "\nSweep backends (bitboard rows " << (BitboardSweeper::UsesAvx2() ? "with" : "without") << " AVX2)\n";
+		BenchmarkSweepBackends(out, Size2D{ 256, 256 }, 5);
+		BenchmarkSweepBackends(out, Size2D{ 256, 256 }, 12);
+		BenchmarkSweepBackends(out, Size2D{ 1024, 1024 }, 5);
+
+		out << "\nTopologies, 256x256, 8% mines\n";
+		BenchmarkTopology<SquareTopology>(out, "Square", Size2D{ 256, 256 }, 8);
+		BenchmarkTopology<TorusTopology>(out, "Torus", Size2D{ 256, 256 }, 8);
+		BenchmarkTopology<HexTopology>(out, "Hex", Size2D{ 256, 256 }, 8);
+
+		const auto wide_board = Size2D{ 16384, 256 };
+		out << "\nBoard layouts, " << wide_board.width << 'x' << wide_board.height << ", 10% mines\n";
+		BenchmarkLayout<RowMajorLayout>(out, "Row-major", wide_board, 10);
+		BenchmarkLayout<TiledLayout<8>>(out, "8x8 tiles", wide_board, 10);
+		BenchmarkLayout<MortonLayout<8>>(out, "8x8 Morton tiles", wide_board, 10);
+
+		out << "\nConcurrent reveals on one board (hardware threads: " << std::thread::hardware_concurrency() << ")\n";
+		CheckConcurrentReveals(out, Size2D{ 256, 256 }, 6, 16, 64);
+		for (auto thread_count : { 1u, 2u, 4u, 8u })
+			BenchmarkConcurrentReveals(out, Size2D{ 1024, 1024 }, 8, thread_count);
+
+		out << "\nProbabilityMap hints\n";
+		BenchmarkHints(out, ExpertBoard::BoardSize(), 21, 200);
+	}
+}
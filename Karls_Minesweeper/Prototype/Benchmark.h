@@ -0,0 +1,13 @@
+#pragma once
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <ostream>
+
+namespace kms
+{
+	// Time the interchangeable generation and reveal paths against each other and print the results
+	void RunBenchmarks(std::ostream& out);
+}
+
+#endif // !BENCHMARK_H_
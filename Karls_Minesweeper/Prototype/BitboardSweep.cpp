@@ -0,0 +1,286 @@
+
+#include "BitboardSweep.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The AVX2 row operations are compiled on every x86-64 build and chosen at run time, so the program needs no /arch:AVX2
+// and still runs on processors without it
+#if defined(_M_X64) || defined(__x86_64__)
+#define KMS_BITBOARD_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define KMS_TARGET_AVX2
+#else
+#define KMS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace kms
+{
+	namespace
+	{
+		// word is never 0
+		unsigned CountTrailingZeros(std::uint64_t word)
+		{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			unsigned long index = 0;
+			_BitScanForward64(&index, word);
+			return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+			// 32-bit targets only have the 32-bit scan, look in the high half when the low one is empty
+			unsigned long index = 0;
+			if (_BitScanForward(&index, static_cast<unsigned long>(word)))
+				return static_cast<unsigned>(index);
+			_BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+			return static_cast<unsigned>(index) + 32;
+#else
+			return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+		}
+
+		// Every tile of the row and the tiles left and right of it, bits beyond the board width are cleared
+		void SpreadRow(const std::uint64_t* row, std::uint64_t* spread_row, unsigned count, std::uint64_t last_word_mask)
+		{
+			for (auto i = 0u; i < count; ++i)
+			{
+				const auto carry_from_below = i > 0 ? row[i - 1] >> 63 : 0;
+				const auto carry_from_above = i + 1 < count ? row[i + 1] << 63 : 0;
+				spread_row[i] = row[i] | (row[i] << 1) | carry_from_below | (row[i] >> 1) | carry_from_above;
+			}
+			spread_row[count - 1] &= last_word_mask;
+		}
+
+		// next = (above | row | below) & open over count words, returns whether next differs from current
+		bool CombineRowsScalar(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below, const std::uint64_t* open,
+			const std::uint64_t* current, std::uint64_t* next, unsigned count)
+		{
+			std::uint64_t changed = 0;
+			for (auto i = 0u; i < count; ++i)
+			{
+				next[i] = (above[i] | row[i] | below[i]) & open[i];
+				changed |= next[i] ^ current[i];
+			}
+			return changed != 0;
+		}
+
+#ifdef KMS_BITBOARD_AVX2
+		KMS_TARGET_AVX2 bool CombineRowsAvx2(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below, const std::uint64_t* open,
+			const std::uint64_t* current, std::uint64_t* next, unsigned count)
+		{
+			unsigned i = 0;
+			std::uint64_t changed = 0;
+
+			auto changed_lanes = _mm256_setzero_si256();
+			for (; i + 4 <= count; i += 4)
+			{
+				const auto combined = _mm256_and_si256(
+					_mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i))),
+						_mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + i))),
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(open + i)));
+
+				changed_lanes = _mm256_or_si256(changed_lanes, _mm256_xor_si256(combined, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current + i))));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(next + i), combined);
+			}
+			changed = !_mm256_testz_si256(changed_lanes, changed_lanes);
+
+			for (; i < count; ++i)
+			{
+				next[i] = (above[i] | row[i] | below[i]) & open[i];
+				changed |= next[i] ^ current[i];
+			}
+
+			return changed != 0;
+		}
+
+		// AVX2 needs the processor to have it and the operating system to save the ymm registers
+		bool DetectAvx2()
+		{
+#ifdef _MSC_VER
+			int info[4] = {};
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			__cpuid(info, 1);
+			const bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+
+			__cpuidex(info, 7, 0);
+			return os_saves_ymm && (info[1] & (1 << 5));
+#else
+			// may run from a static initializer, before libgcc would have filled in the cpu model itself
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#endif
+
+		using CombineRows_t = bool (*)(const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, std::uint64_t*, unsigned);
+
+		CombineRows_t SelectCombineRows()
+		{
+#ifdef KMS_BITBOARD_AVX2
+			if (DetectAvx2())
+				return CombineRowsAvx2;
+#endif
+			return CombineRowsScalar;
+		}
+
+		const CombineRows_t CombineRows = SelectCombineRows();
+	}
+
+	BitboardSweeper::BitboardSweeper(const Size2D& board_size, std::function<int(Pos2D)> fn_get_tile_data)
+		: board_size_(board_size)
+		, row_words_((board_size.width + 63) / 64)
+		, last_word_mask_(board_size.width % 64 ? (Word_t{ 1 } << (board_size.width % 64)) - 1 : ~Word_t{ 0 })
+		, blanks_(static_cast<std::size_t>(row_words_) * board_size.height, 0)
+	{
+		for (auto y = 0u; y < board_size_.height; ++y)
+		{
+			auto row = blanks_.begin() + static_cast<std::size_t>(y) * row_words_;
+			for (auto x = 0u; x < board_size_.width; ++x)
+				row[x / 64] |= static_cast<Word_t>(fn_get_tile_data(Position2D(x, y)) == 0) << (x % 64);
+		}
+	}
+
+	bool BitboardSweeper::UsesAvx2()
+	{
+#ifdef KMS_BITBOARD_AVX2
+		return CombineRows == CombineRowsAvx2;
+#else
+		return false;
+#endif
+	}
+
+	bool BitboardSweeper::IsBlank(const Pos2D& position) const
+	{
+		return (blanks_[static_cast<std::size_t>(position.y) * row_words_ + position.x / 64] >> (position.x % 64)) & 1u;
+	}
+
+	// Make the rows [ybegin, yend) of the workspace ready for a sweep that has not touched them yet: nothing flooded and every
+	// blank open. prepared_begin and prepared_end bound the rows made ready so far.
+	void BitboardSweeper::PrepareRows(BitboardWorkspace& workspace, unsigned ybegin, unsigned yend, unsigned& prepared_begin, unsigned& prepared_end) const
+	{
+		const auto prepare = [&](unsigned y) {
+			const auto offset = static_cast<std::size_t>(y) * row_words_;
+			std::fill_n(workspace.area.begin() + offset, row_words_, Word_t{ 0 });
+			std::copy_n(blanks_.begin() + offset, row_words_, workspace.open.begin() + offset);
+			std::fill_n(workspace.spread.begin() + offset + row_words_, row_words_, Word_t{ 0 });
+		};
+
+		for (; prepared_begin > ybegin; --prepared_begin)
+			prepare(prepared_begin - 1);
+		for (; prepared_end < yend; ++prepared_end)
+			prepare(prepared_end);
+	}
+
+	void BitboardSweeper::Sweep(const Pos2D& start_position, std::function<bool(Pos2D)> fn_clear_tile) const
+	{
+		auto workspace = BitboardWorkspace{};
+		Sweep(start_position, fn_clear_tile, workspace);
+	}
+
+	void BitboardSweeper::Sweep(const Pos2D& start_position, std::function<bool(Pos2D)> fn_clear_tile, BitboardWorkspace& workspace) const
+	{
+		if (start_position.x >= board_size_.width || start_position.y >= board_size_.height)
+			throw(std::out_of_range("Not on board!"));
+
+		if (!fn_clear_tile(start_position) || !IsBlank(start_position))
+			return;
+
+		// the rows are sized once per board, their content is only made ready around the rows this sweep reaches
+		const auto spread_size = static_cast<std::size_t>(board_size_.height + 2) * row_words_;
+		if (workspace.area.size() != blanks_.size() || workspace.spread.size() != spread_size)
+		{
+			workspace.area.assign(blanks_.size(), 0);
+			workspace.open.assign(blanks_.size(), 0);
+			workspace.spread.assign(spread_size, 0);
+			workspace.next_row.assign(row_words_, 0);
+		}
+
+		// area is the flooded blanks. open the blanks it may still enter, a blank fn_clear_tile refuses is taken out and
+		// stops the flood like a number. spread holds every row of area spread sideways, one row down, with a zero row of
+		// padding above and below the board.
+		auto* area = workspace.area.data();
+		auto* open = workspace.open.data();
+		auto* spread = workspace.spread.data() + row_words_;
+		auto* next = workspace.next_row.data();
+
+		auto prepared_begin = start_position.y;
+		auto prepared_end = start_position.y;
+		PrepareRows(workspace, start_position.y > 0 ? start_position.y - 1 : 0u, std::min(start_position.y + 2, board_size_.height), prepared_begin, prepared_end);
+
+		const auto start_offset = static_cast<std::size_t>(start_position.y) * row_words_;
+		area[start_offset + start_position.x / 64] |= Word_t{ 1 } << (start_position.x % 64);
+		SpreadRow(area + start_offset, spread + start_offset, row_words_, last_word_mask_);
+
+		// rows changed by the last pass, only they and the rows next to them can change in the next one
+		auto changed_begin = start_position.y;
+		auto changed_end = start_position.y + 1;
+
+		while (changed_begin < changed_end)
+		{
+			const auto ybegin = changed_begin > 0 ? changed_begin - 1 : 0u;
+			const auto yend = std::min(changed_end + 1, board_size_.height);
+			PrepareRows(workspace, ybegin > 0 ? ybegin - 1 : 0u, std::min(yend + 1, board_size_.height), prepared_begin, prepared_end);
+
+			changed_begin = board_size_.height;
+			changed_end = 0;
+
+			// a row taking in tiles is spread again at once, so the rows below it see them in the same pass
+			for (auto y = ybegin; y < yend; ++y)
+			{
+				const auto offset = static_cast<std::size_t>(y) * row_words_;
+				if (!CombineRows(spread + offset - row_words_, spread + offset, spread + offset + row_words_, open + offset, area + offset, next, row_words_))
+					continue;
+
+				// clear the blanks this row added, before they spread any further
+				auto added_any = false;
+				for (auto i = 0u; i < row_words_; ++i)
+				{
+					for (auto added = next[i] & ~area[offset + i]; added; added &= added - 1)
+					{
+						if (fn_clear_tile(Position2D(i * 64 + CountTrailingZeros(added), y)))
+						{
+							area[offset + i] |= added & (~added + 1);
+							added_any = true;
+						}
+						else
+							open[offset + i] &= ~(added & (~added + 1));
+					}
+				}
+
+				if (!added_any)
+					continue;
+
+				SpreadRow(area + offset, spread + offset, row_words_, last_word_mask_);
+				changed_begin = std::min(changed_begin, y);
+				changed_end = y + 1;
+			}
+		}
+
+		// take in the numbers around the blank area, the dilation of area minus the blanks. The blanks around it are the
+		// refused ones, every other blank next to the area is part of it. The area lies inside the prepared rows, and the
+		// prepared rows outside it are zero.
+		for (auto y = prepared_begin; y < prepared_end; ++y)
+		{
+			const auto offset = static_cast<std::size_t>(y) * row_words_;
+			const auto* above = y > prepared_begin ? spread + offset - row_words_ : nullptr;
+			const auto* below = y + 1 < prepared_end ? spread + offset + row_words_ : nullptr;
+			for (auto i = 0u; i < row_words_; ++i)
+			{
+				const auto dilated = spread[offset + i] | (above ? above[i] : 0) | (below ? below[i] : 0);
+				for (auto word = dilated & ~blanks_[offset + i]; word; word &= word - 1)
+					fn_clear_tile(Position2D(i * 64 + CountTrailingZeros(word), y));
+			}
+		}
+	}
+
+	void BitboardSweep(const Size2D& board_size, const Pos2D& start_position, std::function<int(Pos2D)> fn_get_tile_data, std::function<bool(Pos2D)> fn_clear_tile)
+	{
+		BitboardSweeper(board_size, fn_get_tile_data).Sweep(start_position, fn_clear_tile);
+	}
+}
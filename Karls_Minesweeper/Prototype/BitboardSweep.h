@@ -0,0 +1,60 @@
+#pragma once
+#ifndef BITBOARDSWEEP_H_
+#define BITBOARDSWEEP_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Minesweep_Basics.h"
+
+namespace kms
+{
+	// Rows kept between sweeps, so a caller sweeping many times allocates them once per board size. A sweep only makes
+	// ready the rows around the area it floods, a small reveal on a large board costs a few rows rather than the board.
+	struct BitboardWorkspace
+	{
+		std::vector<std::uint64_t> area;
+		std::vector<std::uint64_t> open;
+		std::vector<std::uint64_t> spread;
+		std::vector<std::uint64_t> next_row;
+	};
+
+	// Alternative to ScanlineSweep that floods whole rows of 64 tiles at a time. The blank tiles are kept as rows of
+	// 64 bit words and the area is grown by masked dilation (shift left/right, OR with the rows above and below,
+	// AND with the blanks) until it stops changing, then dilated once more to take in the numbers around it. Each pass
+	// only visits the rows next to the ones the previous pass changed.
+	// Uses AVX2 for the row operations on x86-64 processors that have it, chosen at run time.
+	//
+	// Like ScanlineSweep the flood stops at tiles fn_clear_tile refuses, so flagged or already cleared blanks bound it.
+	// fn_clear_tile is called once for every tile the flood reaches, in row order rather than scanline order.
+	class BitboardSweeper
+	{
+	public:
+		// Reads every tile once to build the blank mask, keep the sweeper around to sweep the same board again
+		BitboardSweeper(const Size2D& board_size, std::function<int(Pos2D)> fn_get_tile_data);
+
+		void Sweep(const Pos2D& start_position, std::function<bool(Pos2D)> fn_clear_tile) const;
+		void Sweep(const Pos2D& start_position, std::function<bool(Pos2D)> fn_clear_tile, BitboardWorkspace& workspace) const;
+
+		const Size2D& BoardSize() const { return board_size_; }
+
+		// Whether this process sweeps with AVX2
+		static bool UsesAvx2();
+
+	private:
+		using Word_t = std::uint64_t;
+
+		bool IsBlank(const Pos2D& position) const;
+		void PrepareRows(BitboardWorkspace& workspace, unsigned ybegin, unsigned yend, unsigned& prepared_begin, unsigned& prepared_end) const;
+
+		Size2D board_size_;
+		unsigned row_words_ = 0;
+		Word_t last_word_mask_ = 0;
+		std::vector<Word_t> blanks_;
+	};
+
+	// Same signature as ScanlineSweep, builds a BitboardSweeper for the one sweep
+	void BitboardSweep(const Size2D& board_size, const Pos2D& start_position, std::function<int(Pos2D)> fn_get_tile_data, std::function<bool(Pos2D)> fn_clear_tile);
+}
+
+#endif // !BITBOARDSWEEP_H_
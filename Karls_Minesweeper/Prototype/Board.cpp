@@ -0,0 +1,88 @@
+
+#include "Board.h"
+#include <chrono>
+#include <exception>
+#include <utility>
+
+namespace kms
+{
+	SharedBoard_t BoardPool::Acquire(const Size2D& board_size, unsigned coverage, Seed_t seed, EBoardGeneration generation)
+	{
+		const auto key = Key_t(board_size.width, board_size.height, coverage, seed);
+
+		for (;;)
+		{
+			std::promise<std::weak_ptr<const Board>> generated;
+			PooledBoard_t pooled;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+
+				auto& entry = boards_[key];
+				if (!entry.valid() || IsExpired(entry))
+				{
+					entry = generated.get_future().share();
+
+					if (boards_.size() >= prune_threshold_)
+						PruneExpired();
+				}
+				else
+				{
+					pooled = entry;
+				}
+			}
+
+			// someone else generates or generated the board, wait for it and start over if it was dropped meanwhile
+			if (pooled.valid())
+			{
+				if (auto board = pooled.get().lock())
+					return board;
+				continue;
+			}
+
+			try
+			{
+				auto board = std::make_shared<const Board>(board_size, coverage, seed, generation);
+				generated.set_value(board);
+				return board;
+			}
+			catch (...)
+			{
+				// the next caller generates again, the ones waiting now get the exception
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					boards_.erase(key);
+				}
+				generated.set_exception(std::current_exception());
+				throw;
+			}
+		}
+	}
+
+	std::size_t BoardPool::BoardCount() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		std::size_t count = 0;
+		for (const auto& pooled : boards_)
+			count += !IsExpired(pooled.second);
+		return count;
+	}
+
+	bool BoardPool::IsExpired(const PooledBoard_t& pooled)
+	{
+		return pooled.wait_for(std::chrono::seconds(0)) == std::future_status::ready && pooled.get().expired();
+	}
+
+	void BoardPool::PruneExpired()
+	{
+		for (auto itr = boards_.begin(); itr != boards_.end();)
+		{
+			if (IsExpired(itr->second))
+				itr = boards_.erase(itr);
+			else
+				++itr;
+		}
+
+		prune_threshold_ = boards_.size() * 2 + 64;
+	}
+}
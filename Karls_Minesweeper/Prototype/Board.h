@@ -0,0 +1,204 @@
+#pragma once
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Minesweep_Basics.h"
+#include "BoardLayout.h"
+#include "MineField.h"
+
+namespace kms
+{
+	// How a board built from a seed gets its tiles: all up front, or each tile the first time it is asked for.
+	// Both give the same tiles, lazy boards cost next to nothing until played and only for the rows played on.
+	enum class EBoardGeneration
+	{
+		eager,
+		lazy
+	};
+
+	// Generated board, immutable once constructed so any number of sessions can share it.
+	// T_Layout (BoardLayout.h) decides where every tile is stored, generation fills the tiles in that order and TileAt
+	// reads them through it. Offset is the storage index of a position, per tile state kept next to the board, like a
+	// session's bitmaps, is indexed by it too.
+	template<class T_Layout = RowMajorLayout>
+	class BasicBoard
+	{
+	public:
+		using Layout_t = T_Layout;
+
+		BasicBoard(const Size2D& board_size, unsigned coverage, Seed_t seed, EBoardGeneration generation = EBoardGeneration::eager);
+
+		// tiles in row-major order, the order PlaceMines returns them in
+		BasicBoard(const Size2D& board_size, TilesVector_t tiles);
+
+		Tile_t TileAt(const Pos2D& position) const { return lazy_tiles_ ? lazy_tiles_->TileAt(position) : tiles_[Offset(position)]; }
+		const Size2D& BoardSize() const { return board_size_; }
+		EBoardGeneration Generation() const { return lazy_tiles_ ? EBoardGeneration::lazy : EBoardGeneration::eager; }
+
+		// Throws std::out_of_range if the position is off the board, checked per axis
+		std::size_t Offset(const Pos2D& position) const
+		{
+			if (position.x >= board_size_.width || position.y >= board_size_.height)
+				throw(std::out_of_range("Not on board!"));
+			return T_Layout::Offset(board_size_, position);
+		}
+
+		// Number of offsets, including the padding of the layout
+		std::size_t StorageSize() const { return T_Layout::StorageSize(board_size_); }
+
+		// Counted on first call for lazy boards, which decides every tile's mine once but memoizes nothing
+		unsigned MineCount() const;
+
+	private:
+		void PlaceTiles(unsigned coverage, Seed_t seed);
+
+		Size2D board_size_;
+		TilesVector_t tiles_;
+		std::unique_ptr<const LazyMineField> lazy_tiles_;
+		Seed_t seed_ = 0;
+		unsigned coverage_ = 0;
+		mutable std::once_flag mine_count_once_;
+		mutable unsigned mine_count_ = 0;
+	};
+
+	using Board = BasicBoard<>;
+
+	using SharedBoard_t = std::shared_ptr<const Board>;
+
+	// Hands out the same board to everyone asking for the same size, coverage and seed while anyone still plays it,
+	// so a tournament of N players on one seed costs one board plus N players' tile states
+	class BoardPool
+	{
+	public:
+		// The board is generated the way the first caller asks for, the tiles are the same either way.
+		// Generation runs outside the pool's lock, callers for the same board wait for it and callers for other boards do not.
+		SharedBoard_t Acquire(const Size2D& board_size, unsigned coverage, Seed_t seed, EBoardGeneration generation = EBoardGeneration::eager);
+
+		// Boards currently shared, boards no one holds any longer are dropped lazily
+		std::size_t BoardCount() const;
+
+	private:
+		using Key_t = std::tuple<unsigned, unsigned, unsigned, Seed_t>;
+
+		// Published before the board is generated and ready once it is, the pool itself never keeps a board alive
+		using PooledBoard_t = std::shared_future<std::weak_ptr<const Board>>;
+
+		static bool IsExpired(const PooledBoard_t& pooled);
+		void PruneExpired();
+
+		mutable std::mutex mutex_;
+		std::map<Key_t, PooledBoard_t> boards_;
+		std::size_t prune_threshold_ = 64;
+	};
+
+	template<class T_Layout>
+	BasicBoard<T_Layout>::BasicBoard(const Size2D& board_size, unsigned coverage, Seed_t seed, EBoardGeneration generation)
+		: board_size_(board_size)
+		, seed_(seed)
+		, coverage_(coverage)
+	{
+		if (generation == EBoardGeneration::lazy)
+			lazy_tiles_ = std::make_unique<const LazyMineField>(board_size, coverage, seed);
+		else
+			PlaceTiles(coverage, seed);
+	}
+
+	template<class T_Layout>
+	BasicBoard<T_Layout>::BasicBoard(const Size2D& board_size, TilesVector_t tiles)
+		: board_size_(board_size)
+	{
+		if (tiles.size() != Size(board_size_))
+			throw(std::invalid_argument("Tiles do not match the board size!"));
+
+		if constexpr (std::is_same_v<T_Layout, RowMajorLayout>)
+		{
+			tiles_ = std::move(tiles);
+		}
+		else
+		{
+			tiles_.assign(StorageSize(), 0);
+			T_Layout::CopyFromRowMajor(board_size_, tiles.data(), tiles_.data());
+		}
+	}
+
+	template<class T_Layout>
+	void BasicBoard<T_Layout>::PlaceTiles(unsigned coverage, Seed_t seed)
+	{
+		if constexpr (std::is_same_v<T_Layout, RowMajorLayout>)
+		{
+			tiles_ = PlaceMines(board_size_, coverage, seed);
+		}
+		else
+		{
+			// One band of block rows at a time: the mines of the band and the rows around it go into a small window with a
+			// zero border, every count is read from the window at fixed strides and the band is then stored in the layout.
+			// The window keeps its last two rows for the next band, so every mine is decided once.
+			const auto block = T_Layout::block_size;
+			const auto width = board_size_.width;
+			const auto stride = std::size_t{ width } + 2;
+			const auto band_storage = T_Layout::StorageSize(Size2D{ width, block });
+
+			auto window = std::vector<std::uint8_t>((block + 2) * stride, 0);	// row i holds board row band_y - 1 + i
+			auto band = TilesVector_t(std::size_t{ block } * width);
+
+			const auto fill_window_row = [&](unsigned window_row, unsigned y) {
+				auto* row = window.data() + window_row * stride + 1;
+				for (auto x = 0u; x < width; ++x)
+					row[x] = y < board_size_.height && IsMineAt(seed, coverage, Position2D(x, y));
+			};
+
+			tiles_.assign(StorageSize(), 0);
+			fill_window_row(1, 0);
+			for (auto band_y = 0u; band_y < board_size_.height; band_y += block)
+			{
+				for (auto i = 2u; i < block + 2; ++i)
+					fill_window_row(i, band_y + i - 1);
+
+				const auto rows = std::min(block, board_size_.height - band_y);
+				for (auto y = 0u; y < rows; ++y)
+				{
+					const auto* above = window.data() + y * stride;
+					const auto* row = above + stride;
+					const auto* below = row + stride;
+					auto* tile = band.data() + std::size_t{ y } * width;
+					for (auto x = 0u; x < width; ++x)
+						tile[x] = row[x + 1] ? mine_value : above[x] + above[x + 1] + above[x + 2] + row[x] + row[x + 2] + below[x] + below[x + 1] + below[x + 2];
+				}
+
+				T_Layout::CopyFromRowMajor(Size2D{ width, rows }, band.data(), tiles_.data() + (band_y / block) * band_storage);
+				std::copy_n(window.begin() + block * stride, 2 * stride, window.begin());
+			}
+		}
+	}
+
+	template<class T_Layout>
+	unsigned BasicBoard<T_Layout>::MineCount() const
+	{
+		std::call_once(mine_count_once_, [this] {
+			if (!lazy_tiles_)
+			{
+				mine_count_ = static_cast<unsigned>(std::count(tiles_.begin(), tiles_.end(), mine_value));
+				return;
+			}
+
+			for (auto y = 0u; y < board_size_.height; ++y)
+				for (auto x = 0u; x < board_size_.width; ++x)
+					mine_count_ += IsMineAt(seed_, coverage_, Position2D(x, y));
+		});
+
+		return mine_count_;
+	}
+}
+
+#endif // !BOARD_H_
@@ -0,0 +1,180 @@
+#pragma once
+#ifndef BOARDLAYOUT_H_
+#define BOARDLAYOUT_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "Minesweep_Basics.h"
+
+namespace kms
+{
+	// Layouts map a board position to where its tile is stored, they are the layout policy of BasicBoard (Board.h).
+	// Policies with only static members: StorageSize(board_size) is the number of stored tiles including padding,
+	// Offset(board_size, position) where a tile lives, ForEachPosition(board_size, fn) calls fn(position, offset) for every
+	// tile in storage order, CopyFromRowMajor(board_size, row_major, stored) stores tiles given in row-major order, and
+	// contiguous_rows tells whether a run of tiles on a row is stored as one run. Block layouts also have block_size, every
+	// band of block_size rows is stored in one piece of StorageSize({ width, block_size }) tiles.
+
+	// y * width + x, the layout of GetOffsetIndex
+	struct RowMajorLayout
+	{
+		static constexpr bool contiguous_rows = true;
+
+		static std::size_t StorageSize(const Size2D& board_size) { return Size(board_size); }
+		static std::size_t Offset(const Size2D& board_size, const Pos2D& position) { return std::size_t{ position.y } * board_size.width + position.x; }
+
+		template<class T_Fn>
+		static void ForEachPosition(const Size2D& board_size, T_Fn&& fn)
+		{
+			std::size_t offset = 0;
+			for (auto y = 0u; y < board_size.height; ++y)
+				for (auto x = 0u; x < board_size.width; ++x)
+					fn(Position2D(x, y), offset++);
+		}
+
+		template<class T>
+		static void CopyFromRowMajor(const Size2D& board_size, const T* row_major, T* stored) { std::copy_n(row_major, Size(board_size), stored); }
+	};
+
+	// Block x block tiles stored together, the blocks in row-major order. Moving a row up or down stays inside
+	// the same block most of the time, instead of jumping a whole board width ahead.
+	// The last block column and row are padded, the padding is never visited.
+	template<unsigned T_Block>
+	struct TiledLayout
+	{
+		static_assert(T_Block > 0 && (T_Block & (T_Block - 1)) == 0, "Block size must be a power of two!");
+		static constexpr unsigned block_size = T_Block;
+		static constexpr bool contiguous_rows = false;
+
+		static std::size_t BlocksPerRow(const Size2D& board_size) { return (board_size.width + T_Block - 1) / T_Block; }
+		static std::size_t StorageSize(const Size2D& board_size) { return BlocksPerRow(board_size) * ((board_size.height + T_Block - 1) / T_Block) * T_Block * T_Block; }
+
+		static std::size_t Offset(const Size2D& board_size, const Pos2D& position)
+		{
+			const auto block = (position.y / T_Block) * BlocksPerRow(board_size) + position.x / T_Block;
+			return block * T_Block * T_Block + (position.y % T_Block) * T_Block + position.x % T_Block;
+		}
+
+		template<class T_Fn>
+		static void ForEachPosition(const Size2D& board_size, T_Fn&& fn)
+		{
+			std::size_t offset = 0;
+			for (auto block_y = 0u; block_y < board_size.height; block_y += T_Block)
+			{
+				for (auto block_x = 0u; block_x < board_size.width; block_x += T_Block)
+				{
+					for (auto y = block_y; y < block_y + T_Block; ++y)
+					{
+						for (auto x = block_x; x < block_x + T_Block; ++x, ++offset)
+						{
+							if (x < board_size.width && y < board_size.height)
+								fn(Position2D(x, y), offset);
+						}
+					}
+				}
+			}
+		}
+
+		// block by block, so the stored tiles are written in order and every row of a block is copied as one run
+		template<class T>
+		static void CopyFromRowMajor(const Size2D& board_size, const T* row_major, T* stored)
+		{
+			for (auto block_y = 0u; block_y < board_size.height; block_y += T_Block)
+			{
+				const auto rows = std::min(T_Block, board_size.height - block_y);
+				for (auto block_x = 0u; block_x < board_size.width; block_x += T_Block, stored += T_Block * T_Block)
+				{
+					const auto count = std::min(T_Block, board_size.width - block_x);
+					for (auto y = 0u; y < rows; ++y)
+						std::copy_n(row_major + std::size_t{ block_y + y } * board_size.width + block_x, count, stored + y * T_Block);
+				}
+			}
+		}
+	};
+
+	// Like TiledLayout, but inside a block the tiles follow the Morton (Z) curve, so any 2x2, 4x4, ... square
+	// of a block is stored in one piece. A Morton curve over the whole board would pad a 16384x256 board to 16384x16384.
+	template<unsigned T_Block>
+	struct MortonLayout
+	{
+		static_assert(T_Block > 0 && T_Block <= 256 && (T_Block & (T_Block - 1)) == 0, "Block size must be a power of two up to 256!");
+		static constexpr unsigned block_size = T_Block;
+		static constexpr bool contiguous_rows = false;
+
+		// Spread the low 8 bits of value to the even bits
+		static constexpr std::uint32_t SpreadBits(std::uint32_t value)
+		{
+			value &= 0xFF;
+			value = (value | (value << 4)) & 0x0F0F;
+			value = (value | (value << 2)) & 0x3333;
+			value = (value | (value << 1)) & 0x5555;
+			return value;
+		}
+
+		// Gather the even bits back to the low 8 bits
+		static constexpr std::uint32_t CompactBits(std::uint32_t value)
+		{
+			value &= 0x5555;
+			value = (value | (value >> 1)) & 0x3333;
+			value = (value | (value >> 2)) & 0x0F0F;
+			value = (value | (value >> 4)) & 0x00FF;
+			return value;
+		}
+
+		static std::size_t StorageSize(const Size2D& board_size) { return TiledLayout<T_Block>::StorageSize(board_size); }
+
+		static std::size_t Offset(const Size2D& board_size, const Pos2D& position)
+		{
+			const auto block = (position.y / T_Block) * TiledLayout<T_Block>::BlocksPerRow(board_size) + position.x / T_Block;
+			return block * T_Block * T_Block + (SpreadBits(position.y % T_Block) << 1 | SpreadBits(position.x % T_Block));
+		}
+
+		template<class T_Fn>
+		static void ForEachPosition(const Size2D& board_size, T_Fn&& fn)
+		{
+			std::size_t offset = 0;
+			for (auto block_y = 0u; block_y < board_size.height; block_y += T_Block)
+			{
+				for (auto block_x = 0u; block_x < board_size.width; block_x += T_Block)
+				{
+					for (auto i = 0u; i < T_Block * T_Block; ++i, ++offset)
+					{
+						const auto x = block_x + CompactBits(i);
+						const auto y = block_y + CompactBits(i >> 1);
+						if (x < board_size.width && y < board_size.height)
+							fn(Position2D(x, y), offset);
+					}
+				}
+			}
+		}
+
+		// block by block like TiledLayout, a row of a block is spread over the even offsets of its row bits
+		template<class T>
+		static void CopyFromRowMajor(const Size2D& board_size, const T* row_major, T* stored)
+		{
+			std::array<std::uint32_t, T_Block> spread_bits{};
+			for (auto i = 0u; i < T_Block; ++i)
+				spread_bits[i] = SpreadBits(i);
+
+			for (auto block_y = 0u; block_y < board_size.height; block_y += T_Block)
+			{
+				const auto rows = std::min(T_Block, board_size.height - block_y);
+				for (auto block_x = 0u; block_x < board_size.width; block_x += T_Block, stored += T_Block * T_Block)
+				{
+					const auto count = std::min(T_Block, board_size.width - block_x);
+					for (auto y = 0u; y < rows; ++y)
+					{
+						const auto* row = row_major + std::size_t{ block_y + y } * board_size.width + block_x;
+						const auto row_bits = spread_bits[y] << 1;
+						for (auto x = 0u; x < count; ++x)
+							stored[row_bits | spread_bits[x]] = row[x];
+					}
+				}
+			}
+		}
+	};
+}
+
+#endif // !BOARDLAYOUT_H_
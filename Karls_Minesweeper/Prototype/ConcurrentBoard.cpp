@@ -0,0 +1,80 @@
+
+#include "ConcurrentBoard.h"
+#include <utility>
+
+namespace kms
+{
+	ConcurrentBoard::ConcurrentBoard(SharedBoard_t board)
+		: board_(std::move(board))
+		, word_count_((board_->StorageSize() + word_bits - 1) / word_bits)
+		, cleared_(new std::atomic<Word_t>[word_count_])
+	{
+		Reset();
+	}
+
+	ActionResult ConcurrentBoard::Reveal(const Pos2D& position) const
+	{
+		SweepWorkspace workspace;
+		return Reveal(position, workspace);
+	}
+
+	ActionResult ConcurrentBoard::Reveal(const Pos2D& position, SweepWorkspace& workspace) const
+	{
+		ActionResult result;
+
+		const auto& board_size = BoardSize();
+		const auto& board = *board_;
+
+		auto fn_get_tile_data = [&](const Pos2D& tile_position) {
+			return board.TileAt(tile_position);
+		};
+
+		auto fn_clear_tile = [&](const Pos2D& tile_position) {
+			if (!TryClear(board.Offset(tile_position)))
+				return false;
+
+			AppendClearedTile(result.cleared, tile_position);
+			return true;
+		};
+
+		ScanlineSweep(board_size, position, fn_get_tile_data, fn_clear_tile, workspace);
+
+		// the start tile is the first one the sweep clears, so it is ours if anything is
+		result.mine_hit = !result.cleared.empty() && fn_get_tile_data(position) == mine_value;
+		return result;
+	}
+
+	bool ConcurrentBoard::TryClear(std::size_t offset) const
+	{
+		auto& word = cleared_[offset / word_bits];
+		const auto bit = Word_t{ 1 } << (offset % word_bits);
+
+		// the bits only ever get set, so a plain load turns the common "someone else has it" case away
+		// without taking the cache line exclusively; relaxed is enough as the board itself never changes
+		if (word.load(std::memory_order_relaxed) & bit)
+			return false;
+
+		return !(word.fetch_or(bit, std::memory_order_relaxed) & bit);
+	}
+
+	bool ConcurrentBoard::IsCleared(const Pos2D& position) const
+	{
+		const auto offset = board_->Offset(position);
+		return (cleared_[offset / word_bits].load(std::memory_order_relaxed) >> (offset % word_bits)) & 1u;
+	}
+
+	std::size_t ConcurrentBoard::ClearedCount() const
+	{
+		std::size_t count = 0;
+		for (auto i = 0u; i < word_count_; ++i)
+			for (auto word = cleared_[i].load(std::memory_order_relaxed); word; word &= word - 1)
+				++count;
+		return count;
+	}
+
+	void ConcurrentBoard::Reset()
+	{
+		for (auto i = 0u; i < word_count_; ++i)
+			cleared_[i].store(0, std::memory_order_relaxed);
+	}
+}
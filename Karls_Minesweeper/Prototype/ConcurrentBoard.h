@@ -0,0 +1,49 @@
+#pragma once
+#ifndef CONCURRENTBOARD_H_
+#define CONCURRENTBOARD_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "Minesweep_Basics.h"
+#include "Board.h"
+#include "GameSession.h"
+#include "ScanlineSweep.h"
+
+namespace kms
+{
+	// One board revealed by several players at once, as in co-op mode. The cleared state is an atomic bit per tile
+	// claimed with fetch_or, so reveals on different threads sweep side by side without a lock, every tile is cleared
+	// by exactly one of them, and each reveal gets back exactly the tiles it claimed.
+	class ConcurrentBoard
+	{
+	public:
+		explicit ConcurrentBoard(SharedBoard_t board);
+
+		// Reveal the tile and, if it is blank, sweep the connected blank area, may be called from any number of threads at once.
+		// Tiles another reveal claimed first are left to that reveal, mine_hit is set only for the reveal that claimed the mine.
+		ActionResult Reveal(const Pos2D& position) const;
+		ActionResult Reveal(const Pos2D& position, SweepWorkspace& workspace) const;
+
+		// Claim the tile at the board's Offset, true only for the one caller that cleared it
+		bool TryClear(std::size_t offset) const;
+		bool IsCleared(const Pos2D& position) const;
+		std::size_t ClearedCount() const;
+
+		// Hide every tile again, must not run alongside a Reveal
+		void Reset();
+
+		const Size2D& BoardSize() const { return board_->BoardSize(); }
+		const SharedBoard_t& GetBoard() const { return board_; }
+
+	private:
+		using Word_t = std::uint64_t;
+		static constexpr unsigned word_bits = 64;
+
+		SharedBoard_t board_;
+		std::size_t word_count_;
+		std::unique_ptr<std::atomic<Word_t>[]> cleared_;
+	};
+}
+
+#endif // !CONCURRENTBOARD_H_
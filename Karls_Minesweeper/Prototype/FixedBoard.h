@@ -0,0 +1,241 @@
+#pragma once
+#ifndef FIXEDBOARD_H_
+#define FIXEDBOARD_H_
+
+#include <array>
+#include <cstdint>
+#include "Minesweep_Basics.h"
+#include "MineField.h"
+
+namespace kms
+{
+	// N bits in as few 64 bit words as possible, bit y * width + x is tile (x, y). Bits past N are always kept zero.
+	template<unsigned N>
+	struct Bitboard
+	{
+		static constexpr unsigned word_count = (N + 63) / 64;
+
+		std::array<std::uint64_t, word_count> words{};
+
+		constexpr bool Test(unsigned index) const { return (words[index / 64] >> (index % 64)) & 1u; }
+		constexpr void Set(unsigned index) { words[index / 64] |= std::uint64_t{ 1 } << (index % 64); }
+
+		constexpr bool Any() const
+		{
+			for (auto word : words)
+				if (word)
+					return true;
+			return false;
+		}
+
+		// Moves bit i to bit i + count, bits moved past N are dropped
+		constexpr Bitboard ShiftedUp(unsigned count) const
+		{
+			Bitboard shifted;
+			const auto word_shift = count / 64;
+			const auto bit_shift = count % 64;
+
+			for (auto i = word_count; i-- > word_shift;)
+			{
+				auto word = words[i - word_shift] << bit_shift;
+				if (bit_shift && i > word_shift)
+					word |= words[i - word_shift - 1] >> (64 - bit_shift);
+				shifted.words[i] = word;
+			}
+
+			shifted.Trim();
+			return shifted;
+		}
+
+		// Moves bit i to bit i - count
+		constexpr Bitboard ShiftedDown(unsigned count) const
+		{
+			Bitboard shifted;
+			const auto word_shift = count / 64;
+			const auto bit_shift = count % 64;
+
+			for (auto i = 0u; i + word_shift < word_count; ++i)
+			{
+				auto word = words[i + word_shift] >> bit_shift;
+				if (bit_shift && i + word_shift + 1 < word_count)
+					word |= words[i + word_shift + 1] << (64 - bit_shift);
+				shifted.words[i] = word;
+			}
+
+			return shifted;
+		}
+
+		constexpr void Trim()
+		{
+			if (N % 64)
+				words[word_count - 1] &= (std::uint64_t{ 1 } << (N % 64)) - 1;
+		}
+
+		constexpr Bitboard& operator|=(const Bitboard& other) { for (auto i = 0u; i < word_count; ++i) words[i] |= other.words[i]; return *this; }
+		constexpr Bitboard& operator&=(const Bitboard& other) { for (auto i = 0u; i < word_count; ++i) words[i] &= other.words[i]; return *this; }
+		constexpr Bitboard& operator^=(const Bitboard& other) { for (auto i = 0u; i < word_count; ++i) words[i] ^= other.words[i]; return *this; }
+
+		constexpr Bitboard operator~() const
+		{
+			Bitboard inverted;
+			for (auto i = 0u; i < word_count; ++i)
+				inverted.words[i] = ~words[i];
+			inverted.Trim();
+			return inverted;
+		}
+
+		friend constexpr Bitboard operator|(Bitboard l, const Bitboard& r) { return l |= r; }
+		friend constexpr Bitboard operator&(Bitboard l, const Bitboard& r) { return l &= r; }
+		friend constexpr Bitboard operator^(Bitboard l, const Bitboard& r) { return l ^= r; }
+		friend constexpr bool operator==(const Bitboard& l, const Bitboard& r) { return l.words == r.words; }
+		friend constexpr bool operator!=(const Bitboard& l, const Bitboard& r) { return !(l == r); }
+	};
+
+	// Board whose size is known at compile time. Everything lives in std::array backed bitboards, the neighbour offsets and
+	// border masks are compile time constants, so generation and reveal need neither heap allocations nor bounds checks.
+	// For the same seed and coverage the tiles equal the ones PlaceMines generates.
+	template<unsigned W, unsigned H>
+	class FixedBoard
+	{
+	public:
+		static_assert(W > 0 && H > 0, "Board must have tiles");
+
+		static constexpr unsigned width = W;
+		static constexpr unsigned height = H;
+		static constexpr unsigned tile_count = W * H;
+
+		using Bitboard_t = Bitboard<tile_count>;
+
+		struct Direction
+		{
+			int dx;
+			int dy;
+		};
+
+		static constexpr std::array<Direction, 8> neighbour_directions = { {
+			{ -1, -1 }, { 0, -1 }, { 1, -1 },
+			{ -1,  0 },            { 1,  0 },
+			{ -1,  1 }, { 0,  1 }, { 1,  1 } } };
+
+		static constexpr std::array<int, 8> neighbour_offsets = {
+			-static_cast<int>(W) - 1, -static_cast<int>(W), -static_cast<int>(W) + 1,
+			-1, 1,
+			static_cast<int>(W) - 1, static_cast<int>(W), static_cast<int>(W) + 1 };
+
+		static constexpr Bitboard_t ColumnMask(unsigned column)
+		{
+			Bitboard_t mask;
+			for (auto y = 0u; y < H; ++y)
+				mask.Set(y * W + column);
+			return mask;
+		}
+
+		static constexpr Bitboard_t not_first_column = ~ColumnMask(0);
+		static constexpr Bitboard_t not_last_column = ~ColumnMask(W - 1);
+
+		static constexpr Size2D BoardSize() { return { W, H }; }
+		static constexpr unsigned OffsetIndex(const Pos2D& position) { return position.y * W + position.x; }
+
+		// Bit (x, y) of the result is bit (x + dx, y + dy) of board, tiles outside the board read as zero
+		static constexpr Bitboard_t Neighbour(const Bitboard_t& board, int dx, int dy)
+		{
+			const auto offset = dy * static_cast<int>(W) + dx;
+			auto shifted = offset >= 0 ? board.ShiftedDown(static_cast<unsigned>(offset)) : board.ShiftedUp(static_cast<unsigned>(-offset));
+
+			if (dx > 0)
+				shifted &= not_last_column;
+			else if (dx < 0)
+				shifted &= not_first_column;
+
+			return shifted;
+		}
+
+		// board and every tile next to it
+		static constexpr Bitboard_t Dilate(const Bitboard_t& board)
+		{
+			const auto row = board | (board.ShiftedUp(1) & not_first_column) | (board.ShiftedDown(1) & not_last_column);
+			return row | row.ShiftedUp(W) | row.ShiftedDown(W);
+		}
+
+		void Generate(unsigned coverage, Seed_t seed)
+		{
+			mines_ = Bitboard_t{};
+			for (auto y = 0u; y < H; ++y)
+			{
+				for (auto x = 0u; x < W; ++x)
+				{
+					const auto index = y * W + x;
+					mines_.words[index / 64] |= static_cast<std::uint64_t>(IsMineAt(seed, coverage, Position2D(x, y))) << (index % 64);
+				}
+			}
+
+			// bit sliced add of the eight neighbour boards, every tile gets a four bit count
+			auto& ones = count_planes_[0];
+			auto& twos = count_planes_[1];
+			auto& fours = count_planes_[2];
+			auto& eights = count_planes_[3];
+			ones = twos = fours = eights = Bitboard_t{};
+
+			for (const auto& direction : neighbour_directions)
+			{
+				const auto neighbour = Neighbour(mines_, direction.dx, direction.dy);
+				const auto carry_ones = ones & neighbour;
+				ones ^= neighbour;
+				const auto carry_twos = twos & carry_ones;
+				twos ^= carry_ones;
+				const auto carry_fours = fours & carry_twos;
+				fours ^= carry_twos;
+				eights |= carry_fours;
+			}
+
+			blanks_ = ~(mines_ | ones | twos | fours | eights);
+		}
+
+		Tile_t TileAt(const Pos2D& position) const
+		{
+			const auto index = OffsetIndex(position);
+			if (mines_.Test(index))
+				return mine_value;
+
+			return count_planes_[0].Test(index) | count_planes_[1].Test(index) << 1 | count_planes_[2].Test(index) << 2 | count_planes_[3].Test(index) << 3;
+		}
+
+		const Bitboard_t& Mines() const { return mines_; }
+		const Bitboard_t& Blanks() const { return blanks_; }
+
+		// Reveal the tile and, if it is blank, the connected blank area and the numbers around it.
+		// Returns the tiles that were not in revealed before and adds them to it.
+		Bitboard_t Reveal(Bitboard_t& revealed, const Pos2D& position) const
+		{
+			if (revealed.Test(OffsetIndex(position)))
+				return Bitboard_t{};
+
+			auto area = Bitboard_t{};
+			area.Set(OffsetIndex(position));
+
+			if (blanks_.Test(OffsetIndex(position)))
+			{
+				// grow through the blank tiles until nothing changes, then take in the numbers around them
+				for (auto grown = area; (grown = Dilate(area) & blanks_) != area;)
+					area = grown;
+
+				area = Dilate(area);
+			}
+
+			const auto newly_revealed = area & ~revealed;
+			revealed |= newly_revealed;
+			return newly_revealed;
+		}
+
+	private:
+		Bitboard_t mines_;
+		Bitboard_t blanks_;
+		std::array<Bitboard_t, 4> count_planes_{};	// bit n of the neighbouring mine count of every tile
+	};
+
+	using BeginnerBoard = FixedBoard<9, 9>;
+	using IntermediateBoard = FixedBoard<16, 16>;
+	using ExpertBoard = FixedBoard<30, 16>;
+}
+
+#endif // !FIXEDBOARD_H_
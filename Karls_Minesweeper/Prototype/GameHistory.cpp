@@ -0,0 +1,142 @@
+
+#include "GameHistory.h"
+
+namespace kms
+{
+	namespace
+	{
+		const std::uint8_t step_mine_hit = 0x1;
+
+		void PutVarint(std::pmr::vector<std::uint8_t>& buffer, std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				buffer.push_back(static_cast<std::uint8_t>((value & 0x7F) | 0x80));
+				value >>= 7;
+			}
+			buffer.push_back(static_cast<std::uint8_t>(value));
+		}
+
+		std::uint64_t GetVarint(const std::uint8_t*& itr)
+		{
+			std::uint64_t value = 0;
+			for (unsigned shift = 0;; shift += 7)
+			{
+				const auto byte = *itr++;
+				value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+					return value;
+			}
+		}
+
+		// rows of consecutive spans are usually next to each other, zigzag keeps small negative steps small
+		std::uint64_t ZigZag(std::int64_t value)
+		{
+			return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+		}
+
+		std::int64_t UnZigZag(std::uint64_t value)
+		{
+			return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+		}
+	}
+
+	GameHistory::GameHistory(std::pmr::memory_resource* resource)
+		: buffer_(resource)
+		, step_offsets_(resource)
+	{
+	}
+
+	void GameHistory::Push(const HistoryStep& step)
+	{
+		if (CanRedo())
+		{
+			buffer_.resize(step_offsets_[cursor_]);
+			step_offsets_.resize(cursor_);
+		}
+
+		step_offsets_.push_back(static_cast<std::uint32_t>(buffer_.size()));
+
+		buffer_.push_back(step.mine_hit ? step_mine_hit : 0);
+
+		PutVarint(buffer_, step.cleared.size());
+		auto previous_row = std::int64_t{ 0 };
+		for (const auto& span : step.cleared)
+		{
+			PutVarint(buffer_, ZigZag(static_cast<std::int64_t>(span.row) - previous_row));
+			PutVarint(buffer_, span.range.begin);
+			PutVarint(buffer_, span.range.end - span.range.begin);
+			previous_row = span.row;
+		}
+
+		PutVarint(buffer_, step.toggled_flags.size());
+		for (const auto& position : step.toggled_flags)
+		{
+			PutVarint(buffer_, position.x);
+			PutVarint(buffer_, position.y);
+		}
+
+		++cursor_;
+	}
+
+	HistoryStep GameHistory::Decode(std::size_t step_index) const
+	{
+		const std::uint8_t* itr = buffer_.data() + step_offsets_[step_index];
+
+		HistoryStep step;
+		step.mine_hit = (*itr++ & step_mine_hit) != 0;
+
+		const auto span_count = GetVarint(itr);
+		step.cleared.reserve(span_count);
+		auto row = std::int64_t{ 0 };
+		for (auto i = decltype(span_count){0}; i < span_count; ++i)
+		{
+			row += UnZigZag(GetVarint(itr));
+
+			ClearedSpan span;
+			span.row = static_cast<unsigned>(row);
+			span.range.begin = static_cast<unsigned>(GetVarint(itr));
+			span.range.end = span.range.begin + static_cast<unsigned>(GetVarint(itr));
+			step.cleared.push_back(span);
+		}
+
+		const auto flag_count = GetVarint(itr);
+		step.toggled_flags.reserve(flag_count);
+		for (auto i = decltype(flag_count){0}; i < flag_count; ++i)
+		{
+			const auto x = static_cast<unsigned>(GetVarint(itr));
+			const auto y = static_cast<unsigned>(GetVarint(itr));
+			step.toggled_flags.push_back(Position2D(x, y));
+		}
+
+		return step;
+	}
+
+	HistoryStep GameHistory::Undo()
+	{
+		if (!CanUndo())
+			throw(std::logic_error("Nothing to undo!"));
+
+		return Decode(--cursor_);
+	}
+
+	HistoryStep GameHistory::Redo()
+	{
+		if (!CanRedo())
+			throw(std::logic_error("Nothing to redo!"));
+
+		return Decode(cursor_++);
+	}
+
+	void GameHistory::Clear()
+	{
+		buffer_.clear();
+		step_offsets_.clear();
+		cursor_ = 0;
+	}
+
+	std::size_t GameHistory::MemoryUsage() const
+	{
+		return buffer_.capacity() * sizeof(std::uint8_t) + step_offsets_.capacity() * sizeof(std::uint32_t);
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef GAMEHISTORY_H_
+#define GAMEHISTORY_H_
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "Minesweep_Basics.h"
+
+namespace kms
+{
+	// What one action changed on the board
+	struct HistoryStep
+	{
+		std::vector<ClearedSpan> cleared;
+		std::vector<Pos2D> toggled_flags;
+		bool mine_hit = false;
+	};
+
+	// Undo/redo stack of board changes. Every step is varint encoded into one shared buffer as
+	// [header][span count]{row delta, begin, length}...[flag count]{x, y}..., so a step costs a few bytes
+	// per cleared row rather than a copy of the board.
+	class GameHistory
+	{
+	public:
+		explicit GameHistory(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		// Add a step after the current one, any steps that were undone are dropped
+		void Push(const HistoryStep& step);
+
+		bool CanUndo() const { return cursor_ > 0; }
+		bool CanRedo() const { return cursor_ < step_offsets_.size(); }
+
+		// Step back over the last applied step and return it so the caller can revert it
+		HistoryStep Undo();
+
+		// Step forward again and return the step so the caller can reapply it
+		HistoryStep Redo();
+
+		void Clear();
+
+		std::size_t StepCount() const { return step_offsets_.size(); }
+		std::size_t MemoryUsage() const;
+
+	private:
+		HistoryStep Decode(std::size_t step_index) const;
+
+		std::pmr::vector<std::uint8_t> buffer_;
+		std::pmr::vector<std::uint32_t> step_offsets_;
+		std::size_t cursor_ = 0;	// number of applied steps
+	};
+}
+
+#endif // !GAMEHISTORY_H_
@@ -0,0 +1,381 @@
+
+#include "GameServer.h"
+#include "GameSession.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory_resource>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace kms
+{
+	namespace
+	{
+		const unsigned max_board_tiles = 4096u * 4096u;
+
+		// bigger boards are generated lazily, a session rarely sees more than a fraction of them
+		const unsigned lazy_board_tiles = 1024u * 1024u;
+
+		// pause after a failed accept that may pass, so a server out of descriptors does not spin while connections close
+		const auto accept_retry_delay = std::chrono::milliseconds(10);
+
+		enum class EServerCommand
+		{
+			create,
+			reveal,
+			flag,
+			close,
+			stats
+		};
+
+		// Everything a session allocates comes from its arena, closing the session releases it all at once.
+		// The board itself is shared with the other sessions on it and lives as long as any of them.
+		struct ServerSession
+		{
+			explicit ServerSession(SharedBoard_t board)
+				: arena(Size(board->BoardSize()) / 4 + 4096)
+				, game(std::move(board), &arena)
+			{
+			}
+
+			std::pmr::monotonic_buffer_resource arena;
+			GameSession game;
+		};
+
+		class RequestTokens
+		{
+		public:
+			explicit RequestTokens(const std::string& line)
+				: itr_(line.data())
+				, end_(line.data() + line.size())
+			{
+			}
+
+			std::string Word()
+			{
+				SkipSpaces();
+				const auto begin = itr_;
+				while (itr_ != end_ && *itr_ != ' ' && *itr_ != '\r')
+					++itr_;
+				return std::string(begin, itr_);
+			}
+
+			template<class T>
+			T Number()
+			{
+				SkipSpaces();
+				T value{};
+				const auto result = std::from_chars(itr_, end_, value);
+				if (result.ec != std::errc{})
+					throw(std::invalid_argument("Expected a number"));
+				itr_ = result.ptr;
+				return value;
+			}
+
+		private:
+			void SkipSpaces()
+			{
+				while (itr_ != end_ && *itr_ == ' ')
+					++itr_;
+			}
+
+			const char* itr_;
+			const char* end_;
+		};
+	}
+
+	struct GameServer::Request
+	{
+		EServerCommand command = EServerCommand::stats;
+		std::uint64_t session_id = 0;
+		Size2D board_size;
+		unsigned coverage = 0;
+		Seed_t seed = 0;
+		Pos2D position;
+		Respond_t respond;
+	};
+
+	struct GameServer::Worker
+	{
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::deque<Request> requests;
+		bool stopping = false;
+
+		// only touched from the worker's own thread
+		std::unordered_map<std::uint64_t, std::unique_ptr<ServerSession>> sessions;
+	};
+
+	struct GameServer::Connection
+	{
+		Socket socket;
+		std::mutex write_mutex;
+		std::thread reader;
+		std::atomic<bool> finished{ false };	// set by the reader as its last action, Serve then joins it
+	};
+
+	GameServer::GameServer(unsigned worker_count)
+	{
+		if (worker_count == 0)
+			worker_count = 1;
+
+		for (auto i = 0u; i < worker_count; ++i)
+			workers_.push_back(std::make_unique<Worker>());
+
+		for (auto& worker : workers_)
+			worker->thread = std::thread([this, &worker = *worker] { RunWorker(worker); });
+	}
+
+	GameServer::~GameServer()
+	{
+		Stop();
+
+		for (auto& worker : workers_)
+		{
+			{
+				std::lock_guard<std::mutex> lock(worker->mutex);
+				worker->stopping = true;
+			}
+			worker->wake.notify_one();
+			worker->thread.join();
+		}
+	}
+
+	GameServer::Worker& GameServer::WorkerFor(std::uint64_t session_id)
+	{
+		return *workers_[session_id % workers_.size()];
+	}
+
+	void GameServer::Submit(const std::string& request_line, Respond_t respond)
+	{
+		Request request;
+
+		try
+		{
+			auto tokens = RequestTokens(request_line);
+			const auto command = tokens.Word();
+
+			if (command == "NEW")
+			{
+				request.command = EServerCommand::create;
+				request.board_size.width = tokens.Number<unsigned>();
+				request.board_size.height = tokens.Number<unsigned>();
+				request.coverage = tokens.Number<unsigned>();
+				request.seed = tokens.Number<Seed_t>();
+
+				if (request.board_size.width == 0 || request.board_size.height == 0 ||
+					static_cast<std::uint64_t>(request.board_size.width) * request.board_size.height > max_board_tiles || request.coverage > 100)
+					throw(std::invalid_argument("Invalid board"));
+
+				request.session_id = next_session_id_++;
+			}
+			else if (command == "REVEAL" || command == "FLAG")
+			{
+				request.command = command == "REVEAL" ? EServerCommand::reveal : EServerCommand::flag;
+				request.session_id = tokens.Number<std::uint64_t>();
+				request.position.x = tokens.Number<unsigned>();
+				request.position.y = tokens.Number<unsigned>();
+			}
+			else if (command == "CLOSE")
+			{
+				request.command = EServerCommand::close;
+				request.session_id = tokens.Number<std::uint64_t>();
+			}
+			else if (command == "STATS")
+			{
+				respond("STATS " + std::to_string(WorkerCount()) + ' ' + std::to_string(SessionCount()));
+				return;
+			}
+			else
+			{
+				throw(std::invalid_argument("Unknown command"));
+			}
+		}
+		catch (const std::exception& e)
+		{
+			respond(std::string("ERR ") + e.what());
+			return;
+		}
+
+		request.respond = std::move(respond);
+
+		auto& worker = WorkerFor(request.session_id);
+		{
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.requests.push_back(std::move(request));
+		}
+		worker.wake.notify_one();
+	}
+
+	void GameServer::RunWorker(Worker& worker)
+	{
+		for (;;)
+		{
+			Request request;
+			{
+				std::unique_lock<std::mutex> lock(worker.mutex);
+				worker.wake.wait(lock, [&] { return worker.stopping || !worker.requests.empty(); });
+
+				if (worker.requests.empty())
+					break;
+
+				request = std::move(worker.requests.front());
+				worker.requests.pop_front();
+			}
+
+			std::string response;
+			try
+			{
+				response = Handle(worker, request);
+			}
+			catch (const std::exception& e)
+			{
+				response = std::string("ERR ") + e.what();
+			}
+
+			request.respond(response);
+		}
+
+		session_count_ -= worker.sessions.size();
+		worker.sessions.clear();
+	}
+
+	std::string GameServer::Handle(Worker& worker, const Request& request)
+	{
+		const auto session_id = std::to_string(request.session_id);
+
+		if (request.command == EServerCommand::create)
+		{
+			const auto generation = Size(request.board_size) > lazy_board_tiles ? EBoardGeneration::lazy : EBoardGeneration::eager;
+			worker.sessions.emplace(request.session_id, std::make_unique<ServerSession>(board_pool_.Acquire(request.board_size, request.coverage, request.seed, generation)));
+			++session_count_;
+			return "OK " + session_id;
+		}
+
+		auto itr_session = worker.sessions.find(request.session_id);
+		if (itr_session == worker.sessions.end())
+			return "ERR Unknown session " + session_id;
+
+		auto& game = itr_session->second->game;
+
+		// checked per axis, a position past the end of a row would otherwise wrap onto the next one
+		if ((request.command == EServerCommand::reveal || request.command == EServerCommand::flag) &&
+			(request.position.x >= game.BoardSize().width || request.position.y >= game.BoardSize().height))
+			return "ERR Not on board";
+
+		switch (request.command)
+		{
+		case EServerCommand::reveal:
+		{
+			const auto result = game.Reveal(request.position);
+
+			auto response = "CLEARED " + session_id + (result.mine_hit ? " 1 " : " 0 ") + std::to_string(result.cleared.size());
+			for (const auto& span : result.cleared)
+			{
+				response += ' ';
+				response += std::to_string(span.row);
+				response += ' ';
+				response += std::to_string(span.range.begin);
+				response += ' ';
+				response += std::to_string(span.range.end);
+			}
+			return response;
+		}
+		case EServerCommand::flag:
+			game.ToggleFlag(request.position);
+			return "OK " + session_id;
+		case EServerCommand::close:
+			worker.sessions.erase(itr_session);
+			--session_count_;
+			return "OK " + session_id;
+		default:
+			return "ERR Unexpected command";
+		}
+	}
+
+	void GameServer::Serve(Socket listener)
+	{
+		{
+			std::lock_guard<std::mutex> lock(serve_mutex_);
+			if (stopping_)
+				return;
+			listener_ = &listener;
+		}
+
+		auto listener_failed = false;
+		for (;;)
+		{
+			auto may_retry = false;
+			auto socket = listener.Accept(may_retry);
+
+			std::unique_lock<std::mutex> lock(serve_mutex_);
+			if (stopping_)
+				break;
+
+			// reap the connections whose clients went away, so a long running server holds only the live ones
+			connections_.erase(std::remove_if(connections_.begin(), connections_.end(), [](const std::shared_ptr<Connection>& candidate) {
+				if (!candidate->finished)
+					return false;
+				candidate->reader.join();
+				return true;
+			}), connections_.end());
+
+			if (!socket.IsValid())
+			{
+				listener_failed = !may_retry;
+				if (listener_failed)
+					break;
+
+				// a passing failure, like running out of descriptors, is waited out instead of ending every session
+				lock.unlock();
+				std::this_thread::sleep_for(accept_retry_delay);
+				continue;
+			}
+
+			auto connection = std::make_shared<Connection>();
+			connection->socket = std::move(socket);
+
+			// Serve keeps its own reference until the reader is joined, the responses keep the connection alive while queued
+			connection->reader = std::thread([this, connection] {
+				std::string line;
+				while (connection->socket.ReadLine(line))
+				{
+					Submit(line, [connection](const std::string& response) {
+						std::lock_guard<std::mutex> write_lock(connection->write_mutex);
+						connection->socket.Write(response + '\n');
+					});
+				}
+				connection->finished = true;
+			});
+			connections_.push_back(std::move(connection));
+		}
+
+		std::vector<std::shared_ptr<Connection>> connections;
+		{
+			std::lock_guard<std::mutex> lock(serve_mutex_);
+			listener_ = nullptr;
+			connections.swap(connections_);
+		}
+
+		for (auto& connection : connections)
+		{
+			connection->socket.Shutdown();
+			connection->reader.join();
+		}
+
+		if (listener_failed)
+			throw(std::runtime_error("Could not accept connections!"));
+	}
+
+	void GameServer::Stop()
+	{
+		std::lock_guard<std::mutex> lock(serve_mutex_);
+		stopping_ = true;
+		if (listener_)
+			listener_->Shutdown();
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef GAMESERVER_H_
+#define GAMESERVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Board.h"
+#include "Socket.h"
+
+namespace kms
+{
+	// Hosts many independent games. Sessions are spread over the workers and a session is only ever touched by the
+	// thread of the worker that owns it, so requests for different sessions run concurrently without locking the games.
+	//
+	// Line based protocol, every request is answered with one line:
+	//   NEW <width> <height> <coverage> <seed>  ->  OK <session>
+	//   REVEAL <session> <x> <y>               ->  CLEARED <session> <mine hit 0|1> <span count> {<row> <begin> <end>}...
+	//   FLAG <session> <x> <y>                 ->  OK <session>
+	//   CLOSE <session>                        ->  OK <session>
+	//   STATS                                  ->  STATS <workers> <sessions>
+	// A failed request is answered with ERR <message>.
+	// Sessions created with the same board parameters and seed share one read only board from the pool,
+	// boards of more than a million tiles are generated lazily.
+	class GameServer
+	{
+	public:
+		using Respond_t = std::function<void(const std::string&)>;
+
+		explicit GameServer(unsigned worker_count = std::thread::hardware_concurrency());
+		~GameServer();
+
+		GameServer(const GameServer&) = delete;
+		GameServer& operator=(const GameServer&) = delete;
+
+		// Queue a request line on the worker owning its session, respond is called from that worker's thread
+		void Submit(const std::string& request_line, Respond_t respond);
+
+		// Accept connections until Stop is called, each connection gets a thread reading its requests
+		void Serve(Socket listener);
+		void Stop();
+
+		unsigned WorkerCount() const { return static_cast<unsigned>(workers_.size()); }
+		std::size_t SessionCount() const { return session_count_; }
+
+	private:
+		struct Request;
+		struct Worker;
+		struct Connection;
+
+		void RunWorker(Worker& worker);
+		std::string Handle(Worker& worker, const Request& request);
+		Worker& WorkerFor(std::uint64_t session_id);
+
+		std::vector<std::unique_ptr<Worker>> workers_;
+		std::atomic<std::uint64_t> next_session_id_{ 1 };
+		std::atomic<std::size_t> session_count_{ 0 };
+		BoardPool board_pool_;
+
+		std::mutex serve_mutex_;
+		std::atomic<bool> stopping_{ false };
+		Socket* listener_ = nullptr;
+		std::vector<std::shared_ptr<Connection>> connections_;
+	};
+}
+
+#endif // !GAMESERVER_H_
@@ -0,0 +1,203 @@
+
+#include "GameSession.h"
+#include <utility>
+
+namespace kms
+{
+	void AppendClearedTile(std::vector<ClearedSpan>& spans, const Pos2D& position)
+	{
+		if (!spans.empty() && spans.back().row == position.y && spans.back().range.end == position.x)
+		{
+			++spans.back().range.end;
+			return;
+		}
+
+		ClearedSpan span;
+		span.row = position.y;
+		span.range.begin = position.x;
+		span.range.end = position.x + 1;
+		spans.push_back(span);
+	}
+
+	GameSession::GameSession(SharedBoard_t board, std::pmr::memory_resource* resource)
+		: board_(std::move(board))
+		, revealed_(board_->StorageSize(), resource)
+		, flagged_(board_->StorageSize(), resource)
+		, history_(resource)
+		, sweep_workspace_(resource)
+	{
+	}
+
+	GameSession::GameSession(const Size2D& board_size, const TilesVector_t& tiles, std::pmr::memory_resource* resource)
+		: GameSession(std::make_shared<const Board>(board_size, tiles), resource)
+	{
+	}
+
+	Tile_t GameSession::TileAt(const Pos2D& position) const
+	{
+		return board_->TileAt(position);
+	}
+
+	ETileState GameSession::StateAt(const Pos2D& position) const
+	{
+		const auto offset = board_->Offset(position);
+
+		if (revealed_.Test(offset))
+			return ETileState::revealed;
+
+		return flagged_.Test(offset) ? ETileState::flagged : ETileState::hidden;
+	}
+
+	void GameSession::RevealInto(const Pos2D& position, ActionResult& result)
+	{
+		if (StateAt(position) != ETileState::hidden)
+			return;
+
+		const auto& board_size = BoardSize();
+		const auto& board = *board_;
+
+		auto fn_get_tile_data = [&](const Pos2D& tile_position) {
+			return board.TileAt(tile_position);
+		};
+
+		auto fn_clear_tile = [&](const Pos2D& tile_position) {
+			const auto offset = board.Offset(tile_position);
+			if (revealed_.Test(offset) || flagged_.Test(offset))
+				return false;
+
+			revealed_.Set(offset);
+			AppendClearedTile(result.cleared, tile_position);
+			return true;
+		};
+
+		ScanlineSweep(board_size, position, fn_get_tile_data, fn_clear_tile, sweep_workspace_);
+
+		if (fn_get_tile_data(position) == mine_value)
+		{
+			mine_hit_ = true;
+			result.mine_hit = true;
+		}
+	}
+
+	void GameSession::RecordReveal(const ActionResult& result, bool was_game_over)
+	{
+		if (result.cleared.empty())
+			return;
+
+		HistoryStep step;
+		step.cleared = result.cleared;
+		step.mine_hit = result.mine_hit && !was_game_over;
+		history_.Push(step);
+	}
+
+	void GameSession::SetRevealed(const std::vector<ClearedSpan>& spans, bool revealed)
+	{
+		for (const auto& span : spans)
+		{
+			if constexpr (Board::Layout_t::contiguous_rows)
+			{
+				const auto offset = board_->Offset(Position2D(span.range.begin, span.row));
+				revealed_.Assign(offset, offset + span.range.end - span.range.begin, revealed);
+				continue;
+			}
+
+			for (auto x = span.range.begin; x < span.range.end; ++x)
+			{
+				const auto tile_offset = board_->Offset(Position2D(x, span.row));
+				revealed_.Assign(tile_offset, tile_offset + 1, revealed);
+			}
+		}
+	}
+
+	ActionResult GameSession::Reveal(const Pos2D& position)
+	{
+		const bool was_game_over = mine_hit_;
+
+		ActionResult result;
+		RevealInto(position, result);
+		RecordReveal(result, was_game_over);
+		return result;
+	}
+
+	bool GameSession::ToggleFlag(const Pos2D& position)
+	{
+		const auto offset = board_->Offset(position);
+
+		if (revealed_.Test(offset))
+			return false;
+
+		flagged_.Flip(offset);
+
+		HistoryStep step;
+		step.toggled_flags.push_back(position);
+		history_.Push(step);
+		return true;
+	}
+
+	ActionResult GameSession::Chord(const Pos2D& position)
+	{
+		const bool was_game_over = mine_hit_;
+
+		ActionResult result;
+
+		const auto value = TileAt(position);
+		if (StateAt(position) != ETileState::revealed || value <= 0)
+			return result;
+
+		const auto xbegin = position.x > 0 ? position.x - 1 : 0u;
+		const auto ybegin = position.y > 0 ? position.y - 1 : 0u;
+		const auto xend = position.x + 1 < BoardSize().width ? position.x + 2 : BoardSize().width;
+		const auto yend = position.y + 1 < BoardSize().height ? position.y + 2 : BoardSize().height;
+
+		Tile_t flags = 0;
+		for (auto y = ybegin; y < yend; ++y)
+			for (auto x = xbegin; x < xend; ++x)
+				flags += StateAt(Position2D(x, y)) == ETileState::flagged;
+
+		if (flags != value)
+			return result;
+
+		for (auto y = ybegin; y < yend; ++y)
+			for (auto x = xbegin; x < xend; ++x)
+				RevealInto(Position2D(x, y), result);
+
+		RecordReveal(result, was_game_over);
+		return result;
+	}
+
+	bool GameSession::Undo()
+	{
+		if (!history_.CanUndo())
+			return false;
+
+		const auto step = history_.Undo();
+
+		SetRevealed(step.cleared, false);
+
+		for (const auto& position : step.toggled_flags)
+			flagged_.Flip(board_->Offset(position));
+
+		if (step.mine_hit)
+			mine_hit_ = false;
+
+		return true;
+	}
+
+	bool GameSession::Redo()
+	{
+		if (!history_.CanRedo())
+			return false;
+
+		const auto step = history_.Redo();
+
+		SetRevealed(step.cleared, true);
+
+		for (const auto& position : step.toggled_flags)
+			flagged_.Flip(board_->Offset(position));
+
+		if (step.mine_hit)
+			mine_hit_ = true;
+
+		return true;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef GAMESESSION_H_
+#define GAMESESSION_H_
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "Minesweep_Basics.h"
+#include "Board.h"
+#include "GameHistory.h"
+#include "ScanlineSweep.h"
+#include "TileBitmap.h"
+
+namespace kms
+{
+	enum class ETileState : std::uint8_t
+	{
+		hidden,
+		revealed,
+		flagged
+	};
+
+	struct ActionResult
+	{
+		std::vector<ClearedSpan> cleared;	// newly revealed tiles, in the order the sweep cleared them
+		bool mine_hit = false;
+	};
+
+	// One player's game on a board, reveals go through ScanlineSweep.
+	// The board is shared read only, the player's own state is a revealed and a flagged bit per tile indexed by the board's Offset,
+	// which together with the history and sweep workspace is allocated from the given memory resource.
+	class GameSession
+	{
+	public:
+		explicit GameSession(SharedBoard_t board, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		GameSession(const Size2D& board_size, const TilesVector_t& tiles, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		// Reveal the tile and, if it is blank, sweep the connected blank area. Flagged and already revealed tiles are left alone.
+		ActionResult Reveal(const Pos2D& position);
+
+		// Flag a hidden tile or unflag a flagged one, returns false if the tile is revealed
+		bool ToggleFlag(const Pos2D& position);
+
+		// Reveal the hidden neighbours of a revealed number once as many neighbours as the number are flagged
+		ActionResult Chord(const Pos2D& position);
+
+		// Revert or reapply one action, the cost is proportional to the tiles the action changed.
+		// Return false if there is nothing to undo or redo.
+		bool Undo();
+		bool Redo();
+
+		const GameHistory& History() const { return history_; }
+
+		const Size2D& BoardSize() const { return board_->BoardSize(); }
+		const SharedBoard_t& GetBoard() const { return board_; }
+		const TileBitmap& Revealed() const { return revealed_; }
+		const TileBitmap& Flagged() const { return flagged_; }
+		Tile_t TileAt(const Pos2D& position) const;
+		ETileState StateAt(const Pos2D& position) const;
+		bool IsGameOver() const { return mine_hit_; }
+
+	private:
+		void RevealInto(const Pos2D& position, ActionResult& result);
+		void RecordReveal(const ActionResult& result, bool was_game_over);
+		void SetRevealed(const std::vector<ClearedSpan>& spans, bool revealed);
+
+		SharedBoard_t board_;
+		TileBitmap revealed_;
+		TileBitmap flagged_;
+		bool mine_hit_ = false;
+		GameHistory history_;
+		SweepWorkspace sweep_workspace_;
+	};
+
+	// Appends the tile to the last span if it continues it, otherwise starts a new span
+	void AppendClearedTile(std::vector<ClearedSpan>& spans, const Pos2D& position);
+}
+
+#endif // !GAMESESSION_H_
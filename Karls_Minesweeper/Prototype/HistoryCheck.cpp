@@ -0,0 +1,197 @@
+
+#include "HistoryCheck.h"
+#include "GameSession.h"
+#include <exception>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace kms
+{
+	namespace
+	{
+		struct SessionState
+		{
+			std::vector<ETileState> tiles;	// row-major
+			bool game_over = false;
+
+			bool operator!=(const SessionState& other) const { return tiles != other.tiles || game_over != other.game_over; }
+		};
+
+		SessionState Snapshot(const GameSession& session)
+		{
+			const auto& board_size = session.BoardSize();
+
+			SessionState state;
+			state.tiles.reserve(Size(board_size));
+			for (auto y = 0u; y < board_size.height; ++y)
+				for (auto x = 0u; x < board_size.width; ++x)
+					state.tiles.push_back(session.StateAt(Position2D(x, y)));
+
+			state.game_over = session.IsGameOver();
+			return state;
+		}
+
+		// The session after every step of its history, applied of them currently applied
+		struct Snapshots
+		{
+			std::vector<SessionState> states;
+			std::size_t applied = 0;
+
+			// after an action, keep the state if the action recorded a step. A recorded step drops the undone ones.
+			bool Record(const GameSession& session)
+			{
+				if (session.History().CanRedo() || session.History().StepCount() != applied + 1)
+					return !(Snapshot(session) != states[applied]);
+
+				states.resize(++applied);
+				states.push_back(Snapshot(session));
+				return true;
+			}
+		};
+
+		// Flag the mines around a revealed number and unflag everything else around it, so chording on it reveals
+		bool FlagForChord(GameSession& session, const Pos2D& position, Snapshots& snapshots)
+		{
+			const auto& board_size = session.BoardSize();
+			for (auto y = position.y > 0 ? position.y - 1 : position.y; y <= position.y + 1 && y < board_size.height; ++y)
+			{
+				for (auto x = position.x > 0 ? position.x - 1 : position.x; x <= position.x + 1 && x < board_size.width; ++x)
+				{
+					const auto neighbour = Position2D(x, y);
+					const auto state = session.StateAt(neighbour);
+					if (state == ETileState::revealed || (state == ETileState::flagged) == (session.TileAt(neighbour) == mine_value))
+						continue;
+
+					session.ToggleFlag(neighbour);
+					if (!snapshots.Record(session))
+						return false;
+				}
+			}
+			return true;
+		}
+
+		std::string Describe(const Size2D& board_size, unsigned coverage, Seed_t seed, const std::string& what)
+		{
+			std::ostringstream out;
+			out << board_size.width << 'x' << board_size.height << " coverage " << coverage << " seed " << seed << ": " << what;
+			return out.str();
+		}
+	}
+
+	std::string CheckUndoRedo(const Size2D& board_size, unsigned coverage, Seed_t seed, unsigned action_count)
+	{
+		GameSession session(std::make_shared<const Board>(board_size, coverage, seed));
+		std::mt19937_64 random(seed);
+
+		const auto fn_random_position = [&] {
+			return Position2D(static_cast<unsigned>(random() % board_size.width), static_cast<unsigned>(random() % board_size.height));
+		};
+
+		// states[i] is the session after i applied steps
+		Snapshots snapshots;
+		snapshots.states.push_back(Snapshot(session));
+		const auto fn_unrecorded = [&] { return Describe(board_size, coverage, seed, "an action changed the tiles without recording a step"); };
+
+		try
+		{
+			for (auto action = 0u; action < action_count; ++action)
+			{
+				const auto position = fn_random_position();
+
+				switch (random() % 8)
+				{
+				case 0:
+				{
+					// undo a few steps and sometimes redo one, the next recorded step drops the undone ones for good
+					for (auto undo = 1 + random() % 3; undo > 0 && snapshots.applied > 0; --undo)
+					{
+						if (!session.Undo() || Snapshot(session) != snapshots.states[--snapshots.applied])
+							return Describe(board_size, coverage, seed, "undo during the game did not restore the tiles");
+					}
+
+					if (random() % 2 && snapshots.applied + 1 < snapshots.states.size())
+					{
+						if (!session.Redo() || Snapshot(session) != snapshots.states[++snapshots.applied])
+							return Describe(board_size, coverage, seed, "redo during the game did not restore the tiles");
+					}
+					continue;
+				}
+				case 1:
+				case 2:
+					session.ToggleFlag(position);
+					break;
+				case 3:
+				{
+					if (session.StateAt(position) != ETileState::revealed || session.TileAt(position) <= 0)
+						break;
+
+					if (!FlagForChord(session, position, snapshots))
+						return fn_unrecorded();
+					session.Chord(position);
+					break;
+				}
+				default:
+					// mostly flag mines instead of stepping on them, so games last
+					if (session.TileAt(position) == mine_value && random() % 8 != 0)
+						session.ToggleFlag(position);
+					else
+						session.Reveal(position);
+					break;
+				}
+
+				if (!snapshots.Record(session))
+					return fn_unrecorded();
+			}
+
+			// all the way back, then forward through every step still in the history, the undone ones too
+			for (auto applied = snapshots.applied; applied > 0; --applied)
+			{
+				if (!session.Undo())
+					return Describe(board_size, coverage, seed, "undo refused with " + std::to_string(applied) + " steps applied");
+				if (Snapshot(session) != snapshots.states[applied - 1])
+					return Describe(board_size, coverage, seed, "undo to step " + std::to_string(applied - 1) + " differs from the game at that step");
+			}
+			if (session.Undo())
+				return Describe(board_size, coverage, seed, "undo went past the first step");
+
+			for (auto applied = std::size_t{ 1 }; applied < snapshots.states.size(); ++applied)
+			{
+				if (!session.Redo())
+					return Describe(board_size, coverage, seed, "redo refused at step " + std::to_string(applied));
+				if (Snapshot(session) != snapshots.states[applied])
+					return Describe(board_size, coverage, seed, "redo to step " + std::to_string(applied) + " differs from the game at that step");
+			}
+			if (session.Redo())
+				return Describe(board_size, coverage, seed, "redo went past the last step");
+		}
+		catch (const std::exception& exception)
+		{
+			return Describe(board_size, coverage, seed, std::string("threw ") + exception.what());
+		}
+
+		return {};
+	}
+
+	bool RunHistoryChecks(std::ostream& out, unsigned random_cases)
+	{
+		auto failures = 0u;
+
+		std::mt19937_64 random(0x0DD0);
+		for (auto i = 0u; i < random_cases; ++i)
+		{
+			const auto board_size = Size2D{ 1 + static_cast<unsigned>(random() % 32), 1 + static_cast<unsigned>(random() % 32) };
+			const auto coverage = static_cast<unsigned>(random() % 41);
+			const auto seed = static_cast<Seed_t>(random());
+			const auto action_count = 1 + static_cast<unsigned>(random() % 120);
+
+			const auto failure = CheckUndoRedo(board_size, coverage, seed, action_count);
+			if (!failure.empty() && ++failures <= 10)
+				out << "FAIL " << failure << '\n';
+		}
+
+		out << "Undo/redo checks: " << random_cases - failures << " of " << random_cases << " passed\n";
+		return failures == 0;
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#ifndef HISTORYCHECK_H_
+#define HISTORYCHECK_H_
+
+#include <ostream>
+#include <string>
+#include "Minesweep_Basics.h"
+#include "MineField.h"
+
+namespace kms
+{
+	// Play action_count random reveals, flags and chords on a board generated from seed and coverage, keeping every tile's
+	// state after each recorded step. Then undo every step and redo every step, comparing the session with the kept states
+	// after each one. Returns the first difference found, empty if there is none.
+	std::string CheckUndoRedo(const Size2D& board_size, unsigned coverage, Seed_t seed, unsigned action_count);
+
+	// Run CheckUndoRedo on random boards and densities, print a summary and return whether every case passed
+	bool RunHistoryChecks(std::ostream& out, unsigned random_cases = 2000);
+}
+
+#endif // !HISTORYCHECK_H_
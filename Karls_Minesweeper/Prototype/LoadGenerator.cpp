@@ -0,0 +1,145 @@
+
+#include "LoadGenerator.h"
+#include "Socket.h"
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace kms
+{
+	namespace
+	{
+		std::string Request(Socket& socket, const std::string& request)
+		{
+			std::string response;
+			if (!socket.Write(request + '\n') || !socket.ReadLine(response))
+				throw(std::runtime_error("Server closed the connection!"));
+			if (response.compare(0, 3, "ERR") == 0)
+				throw(std::runtime_error("Server answered " + response));
+			return response;
+		}
+
+		std::uint64_t SessionIdOf(const std::string& response)
+		{
+			std::istringstream tokens(response);
+			std::string status;
+			std::uint64_t session_id = 0;
+			tokens >> status >> session_id;
+			return session_id;
+		}
+
+		std::vector<std::chrono::nanoseconds> RunConnection(const LoadGeneratorOptions& options, unsigned connection_index)
+		{
+			auto socket = Socket::Connect(options.host, options.port);
+			auto random = std::mt19937(connection_index);
+
+			auto sessions = std::vector<std::uint64_t>{};
+			for (auto i = 0u; i < options.sessions_per_connection; ++i)
+			{
+				const auto seed = static_cast<std::uint64_t>(connection_index) << 32 | i;
+				sessions.push_back(SessionIdOf(Request(socket, "NEW " + std::to_string(options.board_size.width) + ' ' + std::to_string(options.board_size.height) + ' ' +
+					std::to_string(options.coverage) + ' ' + std::to_string(seed))));
+			}
+
+			auto latencies = std::vector<std::chrono::nanoseconds>{};
+			latencies.reserve(sessions.size() * options.reveals_per_session);
+
+			for (auto reveal = 0u; reveal < options.reveals_per_session; ++reveal)
+			{
+				for (const auto session_id : sessions)
+				{
+					const auto x = random() % options.board_size.width;
+					const auto y = random() % options.board_size.height;
+					const auto request = "REVEAL " + std::to_string(session_id) + ' ' + std::to_string(x) + ' ' + std::to_string(y);
+
+					const auto begin = std::chrono::steady_clock::now();
+					Request(socket, request);
+					latencies.push_back(std::chrono::steady_clock::now() - begin);
+				}
+			}
+
+			for (const auto session_id : sessions)
+				Request(socket, "CLOSE " + std::to_string(session_id));
+
+			return latencies;
+		}
+	}
+
+	LoadReport RunLoadGenerator(const LoadGeneratorOptions& options)
+	{
+		LoadReport report;
+
+		{
+			auto socket = Socket::Connect(options.host, options.port);
+			std::istringstream tokens(Request(socket, "STATS"));
+			std::string status;
+			tokens >> status >> report.server_workers;
+		}
+
+		auto results = std::vector<std::vector<std::chrono::nanoseconds>>(options.connections);
+		auto errors = std::vector<std::string>(options.connections);
+		auto threads = std::vector<std::thread>{};
+
+		const auto begin = std::chrono::steady_clock::now();
+
+		for (auto i = 0u; i < options.connections; ++i)
+		{
+			threads.emplace_back([&, i] {
+				try
+				{
+					results[i] = RunConnection(options, i);
+				}
+				catch (const std::exception& e)
+				{
+					errors[i] = e.what();
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		report.elapsed = std::chrono::steady_clock::now() - begin;
+
+		for (const auto& error : errors)
+			if (!error.empty())
+				throw(std::runtime_error(error));
+
+		auto latencies = std::vector<std::chrono::nanoseconds>{};
+		for (const auto& result : results)
+			latencies.insert(latencies.end(), result.begin(), result.end());
+
+		std::sort(latencies.begin(), latencies.end());
+
+		report.requests = latencies.size();
+		report.sessions = static_cast<std::size_t>(options.connections) * options.sessions_per_connection;
+		if (!latencies.empty())
+		{
+			report.p50 = latencies[(latencies.size() - 1) * 50 / 100];
+			report.p99 = latencies[(latencies.size() - 1) * 99 / 100];
+			report.max = latencies.back();
+		}
+
+		return report;
+	}
+
+	void PrintLoadReport(std::ostream& out, const LoadReport& report)
+	{
+		const auto workers = std::max(report.server_workers, 1u);
+		const auto requests_per_second = report.elapsed.count() > 0 ? report.requests / report.elapsed.count() : 0.0;
+
+		out << "Sessions:                " << report.sessions << '\n'
+			<< "Server workers:          " << report.server_workers << '\n'
+			<< "Sessions per worker:     " << report.sessions / workers << '\n'
+			<< "Reveals:                 " << report.requests << '\n'
+			<< "Elapsed:                 " << report.elapsed.count() << " s\n"
+			<< "Reveals per second:      " << requests_per_second << '\n'
+			<< "Reveals/s per worker:    " << requests_per_second / workers << '\n'
+			<< "p50:                     " << report.p50.count() << " ns\n"
+			<< "p99:                     " << report.p99.count() << " ns\n"
+			<< "max:                     " << report.max.count() << " ns\n";
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef LOADGENERATOR_H_
+#define LOADGENERATOR_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "Minesweep_Basics.h"
+
+namespace kms
+{
+	struct LoadGeneratorOptions
+	{
+		std::string host = "127.0.0.1";
+		std::uint16_t port = 0;
+		unsigned connections = 4;
+		unsigned sessions_per_connection = 256;
+		unsigned reveals_per_session = 16;
+		Size2D board_size = { 30, 16 };
+		unsigned coverage = 20;
+	};
+
+	struct LoadReport
+	{
+		std::size_t requests = 0;
+		std::size_t sessions = 0;
+		unsigned server_workers = 0;
+		std::chrono::duration<double> elapsed{ 0 };
+		std::chrono::nanoseconds p50{ 0 };
+		std::chrono::nanoseconds p99{ 0 };
+		std::chrono::nanoseconds max{ 0 };
+	};
+
+	// Every connection creates its sessions, reveals random tiles round robin over them with one request in flight,
+	// and closes them again. The latencies are measured for the reveals only.
+	LoadReport RunLoadGenerator(const LoadGeneratorOptions& options);
+
+	void PrintLoadReport(std::ostream& out, const LoadReport& report);
+}
+
+#endif // !LOADGENERATOR_H_
@@ -0,0 +1,145 @@
+
+#include "MineField.h"
+#include <stdexcept>
+
+namespace kms
+{
+	namespace
+	{
+		int ReportNeighbouringMine(int value)
+		{
+			if (value < 0)
+				return value;
+
+			return value + 1;
+		}
+
+		template<class T_Itr>
+		void ReportMineOnNearbyRow(T_Itr nearest, bool left, bool right)
+		{
+			*nearest = ReportNeighbouringMine(*nearest);
+
+			if (left)
+				*(nearest - 1) = ReportNeighbouringMine(*(nearest - 1));
+
+			if (right)
+				*(nearest + 1) = ReportNeighbouringMine(*(nearest + 1));
+		}
+
+		template<class T_Itr>
+		void ReportMineOnCurrentRow(T_Itr curr, bool left, bool right)
+		{
+			*curr = mine_value;
+
+			if (left)
+				*(curr - 1) = ReportNeighbouringMine(*(curr - 1));
+
+			if (right)
+				*(curr + 1) = ReportNeighbouringMine(*(curr + 1));
+		}
+	}
+
+	TilesVector_t PlaceMines(const Size2D& board_size, unsigned coverage, Seed_t seed)
+	{
+		TilesVector_t tiles(Size(board_size), 0);
+
+		for (auto y = 0u; y < board_size.height; ++y)
+		{
+			const bool top_neighbour = y > 0;
+			const bool bottom_neighbour = y < (board_size.height - 1);
+
+			for (auto x = 0u; x < board_size.width; ++x)
+			{
+				const bool left_neighbour = x > 0;
+				const bool right_neighbour = x < (board_size.width - 1);
+
+				const auto curr_tile_offset = y * board_size.width + x;
+
+				if (IsMineAt(seed, coverage, Position2D(x, y)))
+				{
+					auto itr_curr_tile = tiles.begin() + curr_tile_offset;
+
+					ReportMineOnCurrentRow(itr_curr_tile, left_neighbour, right_neighbour);
+
+					if (top_neighbour)
+						ReportMineOnNearbyRow(itr_curr_tile - board_size.width, left_neighbour, right_neighbour);
+
+					if (bottom_neighbour)
+						ReportMineOnNearbyRow(itr_curr_tile + board_size.width, left_neighbour, right_neighbour);
+				}
+			}
+		}
+
+		return tiles;
+	}
+
+	LazyMineField::LazyMineField(const Size2D& board_size, unsigned coverage, Seed_t seed)
+		: board_size_(board_size)
+		, coverage_(coverage)
+		, seed_(seed)
+		, rows_(new std::atomic<Row_t*>[board_size.height])
+	{
+		for (auto y = 0u; y < board_size_.height; ++y)
+			rows_[y].store(nullptr, std::memory_order_relaxed);
+	}
+
+	LazyMineField::~LazyMineField()
+	{
+		for (auto y = 0u; y < board_size_.height; ++y)
+			delete[] rows_[y].load(std::memory_order_relaxed);
+	}
+
+	Tile_t LazyMineField::TileAt(const Pos2D& position) const
+	{
+		if (position.x >= board_size_.width || position.y >= board_size_.height)
+			throw(std::out_of_range("Not on board!"));
+
+		auto& tile = RowAt(position.y)[position.x];
+		auto value = tile.load(std::memory_order_relaxed);
+		if (value == unknown_tile)
+		{
+			value = static_cast<std::int8_t>(IsMineAt(seed_, coverage_, position) ? mine_value : CountNeighbouringMines(position));
+			tile.store(value, std::memory_order_relaxed);
+		}
+
+		return value;
+	}
+
+	LazyMineField::Row_t* LazyMineField::RowAt(unsigned y) const
+	{
+		auto row = rows_[y].load(std::memory_order_acquire);
+		if (row)
+			return row;
+
+		// the loser of a race frees its row and takes the winner's
+		auto fresh = new Row_t[board_size_.width];
+		for (auto x = 0u; x < board_size_.width; ++x)
+			fresh[x].store(unknown_tile, std::memory_order_relaxed);
+
+		if (rows_[y].compare_exchange_strong(row, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+			return fresh;
+
+		delete[] fresh;
+		return row;
+	}
+
+	Tile_t LazyMineField::CountNeighbouringMines(const Pos2D& position) const
+	{
+		const auto xbegin = position.x > 0 ? position.x - 1 : 0u;
+		const auto ybegin = position.y > 0 ? position.y - 1 : 0u;
+		const auto xend = position.x + 1 < board_size_.width ? position.x + 2 : board_size_.width;
+		const auto yend = position.y + 1 < board_size_.height ? position.y + 2 : board_size_.height;
+
+		Tile_t count = 0;
+		for (auto y = ybegin; y < yend; ++y)
+		{
+			for (auto x = xbegin; x < xend; ++x)
+			{
+				if ((x != position.x || y != position.y) && IsMineAt(seed_, coverage_, Position2D(x, y)))
+					++count;
+			}
+		}
+
+		return count;
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef MINEFIELD_H_
+#define MINEFIELD_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "Minesweep_Basics.h"
+
+namespace kms
+{
+	using Seed_t = std::uint64_t;
+
+	// splitmix64 finalizer
+	inline std::uint64_t Mix64(std::uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// Counter based hash of (seed, x, y), the same seed and position always gives the same value.
+	// Inline so a loop over a board computes Mix64(seed) once rather than per tile.
+	inline std::uint64_t MineHash(Seed_t seed, const Pos2D& position)
+	{
+		const auto counter = (static_cast<std::uint64_t>(position.y) << 32) | position.x;
+		return Mix64(Mix64(seed) + counter * 0x9E3779B97F4A7C15ull);
+	}
+
+	// Whether the tile at position holds a mine, coverage is the percentage of tiles that should be mines
+	inline bool IsMineAt(Seed_t seed, unsigned coverage, const Pos2D& position)
+	{
+		// compare the upper 32 bits of the hash against coverage percent of 2^32
+		return (MineHash(seed, position) >> 32) * 100u < (static_cast<std::uint64_t>(coverage) << 32);
+	}
+
+	// Generate every tile of the board up front, a mine tile holds mine_value and any other tile the number of neighbouring mines
+	TilesVector_t PlaceMines(const Size2D& board_size, unsigned coverage, Seed_t seed);
+
+	// Board that decides mines from MineHash and counts the neighbouring mines of a tile the first time it is asked for,
+	// construction is O(1) regardless of the board size and every tile equals the one PlaceMines gives for the same seed.
+	// The counts are memoized a byte per tile in rows allocated on first touch. Rows are installed and tiles written
+	// atomically, so any number of threads may ask at once; two threads counting the same tile store the same value.
+	class LazyMineField
+	{
+	public:
+		LazyMineField(const Size2D& board_size, unsigned coverage, Seed_t seed);
+		~LazyMineField();
+
+		LazyMineField(const LazyMineField&) = delete;
+		LazyMineField& operator=(const LazyMineField&) = delete;
+
+		Tile_t TileAt(const Pos2D& position) const;
+
+		const Size2D& BoardSize() const { return board_size_; }
+		Seed_t Seed() const { return seed_; }
+		unsigned Coverage() const { return coverage_; }
+
+	private:
+		using Row_t = std::atomic<std::int8_t>;
+		static constexpr std::int8_t unknown_tile = -2;
+
+		Row_t* RowAt(unsigned y) const;
+		Tile_t CountNeighbouringMines(const Pos2D& position) const;
+
+		Size2D board_size_;
+		unsigned coverage_ = 0;
+		Seed_t seed_ = 0;
+		std::unique_ptr<std::atomic<Row_t*>[]> rows_;
+	};
+}
+
+#endif // !MINEFIELD_H_
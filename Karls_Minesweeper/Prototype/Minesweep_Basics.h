@@ -81,6 +81,13 @@ namespace kms
 		return r.end;
 	}
 
+	// Tiles [range.begin, range.end) of one row
+	struct ClearedSpan
+	{
+		unsigned row = 0;
+		ClearedRange range;
+	};
+
 	using Tile_t = int;
 	using TilesVector_t = std::vector<Tile_t>;
 }
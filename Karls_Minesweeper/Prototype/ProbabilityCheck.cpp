@@ -0,0 +1,225 @@
+
+#include "ProbabilityCheck.h"
+#include "ProbabilityMap.h"
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace kms
+{
+	namespace
+	{
+		constexpr unsigned brute_force_tiles = 20;
+		constexpr double tolerance = 1e-9;
+
+		// Mine chance of every tile, row-major, by trying every layout of the hidden tiles with the mines still unaccounted for.
+		// Empty if there are more than brute_force_tiles hidden tiles.
+		std::vector<double> BruteForceProbabilities(const GameSession& session)
+		{
+			const auto& board_size = session.BoardSize();
+			const auto& revealed = session.Revealed();
+
+			std::vector<unsigned> hidden;
+			std::vector<unsigned> bit_of(Size(board_size), 0);
+			for (auto offset = 0u; offset < Size(board_size); ++offset)
+			{
+				if (!revealed.Test(offset))
+				{
+					bit_of[offset] = static_cast<unsigned>(hidden.size());
+					hidden.push_back(offset);
+				}
+			}
+			if (hidden.size() > brute_force_tiles)
+				return {};
+
+			// every revealed number as the mask of its hidden neighbours
+			struct Number
+			{
+				std::uint32_t neighbours = 0;
+				std::size_t value = 0;
+			};
+			std::vector<Number> numbers;
+			for (auto y = 0u; y < board_size.height; ++y)
+			{
+				for (auto x = 0u; x < board_size.width; ++x)
+				{
+					if (!revealed.Test(RowMajorLayout::Offset(board_size, Position2D(x, y))))
+						continue;
+
+					Number number;
+					number.value = static_cast<std::size_t>(session.TileAt(Position2D(x, y)));
+					for (auto ny = y > 0 ? y - 1 : y; ny <= y + 1 && ny < board_size.height; ++ny)
+					{
+						for (auto nx = x > 0 ? x - 1 : x; nx <= x + 1 && nx < board_size.width; ++nx)
+						{
+							const auto offset = RowMajorLayout::Offset(board_size, Position2D(nx, ny));
+							if (!revealed.Test(offset))
+								number.neighbours |= std::uint32_t{ 1 } << bit_of[offset];
+						}
+					}
+					numbers.push_back(number);
+				}
+			}
+
+			std::vector<double> probabilities(Size(board_size), 0.0);
+			const auto mine_count = session.GetBoard()->MineCount();
+			if (mine_count > hidden.size())
+				return probabilities;
+
+			// every mask of hidden.size() bits with mine_count of them set, in increasing order
+			const auto end = std::uint64_t{ 1 } << hidden.size();
+			auto layouts = 0.0;
+			for (auto layout = (std::uint64_t{ 1 } << mine_count) - 1; layout < end; )
+			{
+				auto agrees = true;
+				for (const auto& number : numbers)
+				{
+					if (std::bitset<32>(layout & number.neighbours).count() != number.value)
+					{
+						agrees = false;
+						break;
+					}
+				}
+
+				if (agrees)
+				{
+					layouts += 1.0;
+					for (auto bit = 0u; bit < hidden.size(); ++bit)
+					{
+						if ((layout >> bit) & 1u)
+							probabilities[hidden[bit]] += 1.0;
+					}
+				}
+
+				if (layout == 0)
+					break;
+				const auto lowest = layout & (~layout + 1);
+				const auto ripple = layout + lowest;
+				layout = ripple | (((layout ^ ripple) >> 2) / lowest);
+			}
+
+			for (auto& probability : probabilities)
+				probability /= layouts;
+			return probabilities;
+		}
+
+		std::string Describe(const Size2D& board_size, unsigned coverage, Seed_t seed, unsigned reveal, const std::string& what)
+		{
+			std::ostringstream out;
+			out << board_size.width << 'x' << board_size.height << " coverage " << coverage << " seed " << seed << " reveal " << reveal << ": " << what;
+			return out.str();
+		}
+
+		// The first tile where probabilities differ from expected, empty if none does
+		std::string CompareProbabilities(const Size2D& board_size, const std::vector<double>& probabilities, const std::vector<double>& expected)
+		{
+			if (probabilities.size() != expected.size())
+				return "has " + std::to_string(probabilities.size()) + " tiles";
+
+			for (std::size_t offset = 0; offset < expected.size(); ++offset)
+			{
+				if (std::fabs(probabilities[offset] - expected[offset]) > tolerance)
+				{
+					std::ostringstream out;
+					out << "gives " << probabilities[offset] << " at " << offset % board_size.width << ',' << offset / board_size.width
+						<< " where counting every layout gives " << expected[offset];
+					return out.str();
+				}
+			}
+			return {};
+		}
+	}
+
+	std::string CheckProbabilities(const Size2D& board_size, unsigned coverage, Seed_t seed, unsigned reveal_count, unsigned& positions_compared)
+	{
+		GameSession session(std::make_shared<const Board>(board_size, coverage, seed));
+		std::mt19937_64 random(seed);
+
+		ProbabilityMap updated(1 + seed % 3);
+		ProbabilityMap rebuilt(1);
+
+		auto reveal = 0u;
+		try
+		{
+			updated.Rebuild(session);
+
+			for (; reveal < reveal_count; ++reveal)
+			{
+				// a hidden safe tile, so the game goes on
+				std::vector<Pos2D> safe;
+				for (auto y = 0u; y < board_size.height; ++y)
+				{
+					for (auto x = 0u; x < board_size.width; ++x)
+					{
+						if (session.StateAt(Position2D(x, y)) == ETileState::hidden && session.TileAt(Position2D(x, y)) != mine_value)
+							safe.push_back(Position2D(x, y));
+					}
+				}
+				if (safe.empty())
+					break;
+
+				const auto result = session.Reveal(safe[random() % safe.size()]);
+				updated.Update(session, result);
+				rebuilt.Rebuild(session);
+
+				const auto expected = BruteForceProbabilities(session);
+				if (expected.empty() || !updated.IsExact() || !rebuilt.IsExact())
+					continue;
+
+				auto difference = CompareProbabilities(board_size, updated.Probabilities(), expected);
+				if (!difference.empty())
+					return Describe(board_size, coverage, seed, reveal, "Update " + difference);
+
+				difference = CompareProbabilities(board_size, rebuilt.Probabilities(), expected);
+				if (!difference.empty())
+					return Describe(board_size, coverage, seed, reveal, "Rebuild " + difference);
+
+				++positions_compared;
+			}
+
+			try
+			{
+				updated.ProbabilityAt(Position2D(board_size.width, 0));
+				return Describe(board_size, coverage, seed, reveal, "ProbabilityAt took a position right of the board");
+			}
+			catch (const std::out_of_range&)
+			{
+			}
+		}
+		catch (const std::exception& exception)
+		{
+			return Describe(board_size, coverage, seed, reveal, std::string("threw ") + exception.what());
+		}
+
+		return {};
+	}
+
+	bool RunProbabilityChecks(std::ostream& out, unsigned random_cases)
+	{
+		auto failures = 0u;
+		auto positions_compared = 0u;
+
+		std::mt19937_64 random(0xB0B0);
+		for (auto i = 0u; i < random_cases; ++i)
+		{
+			const auto board_size = Size2D{ 1 + static_cast<unsigned>(random() % 6), 1 + static_cast<unsigned>(random() % 6) };
+			const auto coverage = 10 + static_cast<unsigned>(random() % 31);
+			const auto seed = static_cast<Seed_t>(random());
+			const auto reveal_count = 1 + static_cast<unsigned>(random() % 6);
+
+			const auto failure = CheckProbabilities(board_size, coverage, seed, reveal_count, positions_compared);
+			if (!failure.empty() && ++failures <= 10)
+				out << "FAIL " << failure << '\n';
+		}
+
+		out << "Probability checks: " << random_cases - failures << " of " << random_cases << " passed, "
+			<< positions_compared << " positions counted out\n";
+		return failures == 0;
+	}
+}
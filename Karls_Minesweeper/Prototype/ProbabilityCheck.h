@@ -0,0 +1,23 @@
+#pragma once
+#ifndef PROBABILITYCHECK_H_
+#define PROBABILITYCHECK_H_
+
+#include <ostream>
+#include <string>
+#include "Minesweep_Basics.h"
+#include "MineField.h"
+
+namespace kms
+{
+	// Reveal up to reveal_count random safe tiles of a board generated from seed and coverage. After every reveal one
+	// ProbabilityMap is updated and another rebuilt, and both must give every tile the probability counted by enumerating
+	// every mine layout of the hidden tiles that agrees with the revealed numbers and the mine count. Positions with more
+	// than 20 hidden tiles are not compared, positions_compared is raised by the ones that were.
+	// Returns the first difference found, empty if there is none.
+	std::string CheckProbabilities(const Size2D& board_size, unsigned coverage, Seed_t seed, unsigned reveal_count, unsigned& positions_compared);
+
+	// Run CheckProbabilities on random small boards and densities, print a summary and return whether every case passed
+	bool RunProbabilityChecks(std::ostream& out, unsigned random_cases = 600);
+}
+
+#endif // !PROBABILITYCHECK_H_
@@ -0,0 +1,763 @@
+
+#include "ProbabilityMap.h"
+#include "MineField.h"
+#include "Topology.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace kms
+{
+	namespace
+	{
+		// Open constraint states a component may reach while counting before it is sampled instead
+		const std::size_t state_budget = 1u << 16;
+		const unsigned sample_probes = 4096;
+
+		// Layouts by mine total, only the totals from first on that can occur are stored
+		struct MineTotals
+		{
+			unsigned first = 0;
+			std::vector<double> weights;
+
+			// Add the layouts of source with shift more mines each
+			void Add(const MineTotals& source, unsigned shift)
+			{
+				if (source.weights.empty())
+					return;
+
+				const auto source_first = source.first + shift;
+				if (weights.empty())
+					first = source_first;
+				else if (source_first < first)
+				{
+					weights.insert(weights.begin(), first - source_first, 0);
+					first = source_first;
+				}
+
+				const auto offset = source_first - first;
+				if (weights.size() < offset + source.weights.size())
+					weights.resize(offset + source.weights.size(), 0);
+				for (auto k = 0u; k < source.weights.size(); ++k)
+					weights[offset + k] += source.weights[k];
+			}
+		};
+
+		// Counts the mine layouts of a component one tile at a time, in an order where each constraint is finished soon after
+		// it is started. The mines placed so far on the started, unfinished constraints are all the rest of the count depends on,
+		// so layouts leading to the same such state are counted together: a band of frontier tiles costs its length, not 2^length.
+		class ComponentSolver
+		{
+		public:
+			explicit ComponentSolver(ProbabilityMap::Component& component)
+				: component_(component)
+				, tile_constraints_(component.tiles.size())
+			{
+				for (auto c = 0u; c < component.constraints.size(); ++c)
+					for (auto tile : component.constraints[c].tiles)
+						tile_constraints_[tile].push_back(c);
+
+				OrderTiles();
+
+				const auto tile_count = component.tiles.size();
+				component.layouts.assign(tile_count + 1, 0);
+				component.tile_mines.assign((tile_count + 1) * tile_count, 0);
+				component.sampled = false;
+			}
+
+			// Count every layout exactly, false if the component has too many open states
+			bool Count()
+			{
+				const auto steps = order_.size();
+				auto state_index = std::unordered_map<std::string, std::size_t>{};
+
+				// forward: layouts of the tiles before each step, by state and mine total
+				states_.assign(steps + 1, {});
+				states_[0].push_back(State{ std::string(), { 0, { 1.0 } }, { -1, -1 }, {} });
+				std::size_t state_count = 1;
+
+				for (auto step = 0u; step < steps; ++step)
+				{
+					state_index.clear();
+					for (auto& state : states_[step])
+					{
+						for (int value = 0; value < 2; ++value)
+						{
+							std::string next;
+							if (!Advance(step, state.key, value, next))
+								continue;
+
+							auto inserted = state_index.emplace(next, states_[step + 1].size());
+							if (inserted.second)
+							{
+								if (++state_count > state_budget)
+									return false;
+								states_[step + 1].push_back(State{ next, {}, { -1, -1 }, {} });
+							}
+
+							state.next[value] = static_cast<int>(inserted.first->second);
+							states_[step + 1][inserted.first->second].layouts.Add(state.layouts, value);
+						}
+					}
+				}
+
+				// backward: completions of the tiles from each step on, by state and mine total
+				for (auto& state : states_[steps])
+					state.completions = { 0, { 1.0 } };
+				for (auto step = steps; step-- > 0;)
+				{
+					for (auto& state : states_[step])
+					{
+						for (int value = 0; value < 2; ++value)
+							if (state.next[value] >= 0)
+								state.completions.Add(states_[step + 1][state.next[value]].completions, value);
+					}
+				}
+
+				const auto tile_count = component_.tiles.size();
+				for (const auto& state : states_[steps])
+					for (auto k = 0u; k < state.layouts.weights.size(); ++k)
+						component_.layouts[state.layouts.first + k] += state.layouts.weights[k];
+
+				// a tile holds a mine in the layouts that reach its step and continue with a mine
+				for (auto step = 0u; step < steps; ++step)
+				{
+					const auto tile = order_[step];
+					for (const auto& state : states_[step])
+					{
+						if (state.next[1] < 0)
+							continue;
+
+						const auto& layouts = state.layouts;
+						const auto& completions = states_[step + 1][state.next[1]].completions;
+						const auto first = layouts.first + 1 + completions.first;
+						for (auto before = 0u; before < layouts.weights.size(); ++before)
+							for (auto after = 0u; after < completions.weights.size(); ++after)
+								component_.tile_mines[(first + before + after) * tile_count + tile] += layouts.weights[before] * completions.weights[after];
+					}
+				}
+
+				return true;
+			}
+
+			// Estimate the layout counts by Knuth's estimator: walk random paths down the search tree, each leaf reached
+			// stands for the product of the choices on its way
+			void Sample(Seed_t seed)
+			{
+				auto& component = component_;
+				std::fill(component.layouts.begin(), component.layouts.end(), 0);
+				std::fill(component.tile_mines.begin(), component.tile_mines.end(), 0);
+				component.sampled = true;
+				states_.clear();
+
+				const auto tile_count = component.tiles.size();
+				auto mines = std::vector<int>(component.constraints.size());
+				auto unassigned = std::vector<int>(component.constraints.size());
+				auto assignment = std::vector<std::uint8_t>(tile_count);
+
+				auto fn_fits = [&](unsigned tile, int value) {
+					for (auto c : tile_constraints_[tile])
+					{
+						const auto target = component.constraints[c].mines;
+						if (mines[c] + value > target || mines[c] + value + unassigned[c] - 1 < target)
+							return false;
+					}
+					return true;
+				};
+
+				for (auto probe = 0u; probe < sample_probes; ++probe)
+				{
+					std::fill(mines.begin(), mines.end(), 0);
+					for (auto c = 0u; c < component.constraints.size(); ++c)
+						unassigned[c] = static_cast<int>(component.constraints[c].tiles.size());
+
+					double weight = 1.0 / sample_probes;
+					unsigned mine_total = 0;
+					auto step = 0u;
+					for (; step < order_.size(); ++step)
+					{
+						const auto tile = order_[step];
+						const bool can_be_clear = fn_fits(tile, 0);
+						const bool can_be_mine = fn_fits(tile, 1);
+						if (!can_be_clear && !can_be_mine)
+							break;
+
+						int value = can_be_mine ? 1 : 0;
+						if (can_be_clear && can_be_mine)
+						{
+							weight *= 2;
+							value = Mix64(seed + probe * tile_count + step) & 1;
+						}
+
+						assignment[tile] = static_cast<std::uint8_t>(value);
+						mine_total += value;
+						for (auto c : tile_constraints_[tile])
+						{
+							mines[c] += value;
+							--unassigned[c];
+						}
+					}
+
+					if (step < order_.size())
+						continue;
+
+					component.layouts[mine_total] += weight;
+					for (auto tile = 0u; tile < tile_count; ++tile)
+						if (assignment[tile])
+							component.tile_mines[mine_total * tile_count + tile] += weight;
+				}
+			}
+
+		private:
+			struct State
+			{
+				std::string key;			// mines so far on each open constraint, in open_[step] order
+				MineTotals layouts;			// layouts of the tiles before this step
+				int next[2];				// state after this step's tile is clear or a mine, -1 if that breaks a constraint
+				MineTotals completions;		// layouts of the tiles from this step on
+			};
+
+			// Breadth first through shared constraints, so neighbouring tiles are next to each other in the order
+			void OrderTiles()
+			{
+				const auto tile_count = component_.tiles.size();
+				auto queued = std::vector<std::uint8_t>(tile_count, 0);
+				auto constraint_done = std::vector<std::uint8_t>(component_.constraints.size(), 0);
+
+				for (auto first = 0u; first < tile_count; ++first)
+				{
+					if (queued[first])
+						continue;
+
+					queued[first] = 1;
+					order_.push_back(first);
+					for (auto head = order_.size() - 1; head < order_.size(); ++head)
+					{
+						for (auto c : tile_constraints_[order_[head]])
+						{
+							if (constraint_done[c])
+								continue;
+							constraint_done[c] = 1;
+							for (auto tile : component_.constraints[c].tiles)
+							{
+								if (!queued[tile])
+								{
+									queued[tile] = 1;
+									order_.push_back(tile);
+								}
+							}
+						}
+					}
+				}
+
+				step_of_.assign(tile_count, 0);
+				for (auto step = 0u; step < tile_count; ++step)
+					step_of_[order_[step]] = step;
+
+				first_step_.assign(component_.constraints.size(), 0);
+				last_step_.assign(component_.constraints.size(), 0);
+				for (auto c = 0u; c < component_.constraints.size(); ++c)
+				{
+					auto first = std::numeric_limits<unsigned>::max();
+					auto last = 0u;
+					for (auto tile : component_.constraints[c].tiles)
+					{
+						first = std::min(first, step_of_[tile]);
+						last = std::max(last, step_of_[tile]);
+					}
+					first_step_[c] = first;
+					last_step_[c] = last;
+				}
+
+				// open_[step]: constraints with tiles both before and from step on
+				open_.assign(tile_count + 1, {});
+				for (auto step = 0u; step < tile_count; ++step)
+				{
+					for (auto c : open_[step])
+						if (last_step_[c] > step)
+							open_[step + 1].push_back(c);
+					for (auto c : tile_constraints_[order_[step]])
+						if (first_step_[c] == step && last_step_[c] > step)
+							open_[step + 1].push_back(c);
+					std::sort(open_[step + 1].begin(), open_[step + 1].end());
+				}
+			}
+
+			// State after the tile of step is assigned value, false if that breaks one of its constraints
+			bool Advance(unsigned step, const std::string& key, int value, std::string& next) const
+			{
+				const auto tile = order_[step];
+				const auto& open = open_[step];
+
+				auto fn_mines_before = [&](unsigned c) {
+					if (first_step_[c] == step)
+						return 0;
+					return static_cast<int>(key[std::lower_bound(open.begin(), open.end(), c) - open.begin()]);
+				};
+
+				for (auto c : tile_constraints_[tile])
+				{
+					const auto mines = fn_mines_before(c) + value;
+					const auto target = component_.constraints[c].mines;
+					const auto tiles_after = TilesAfter(c, step);
+					if (mines > target || mines + tiles_after < target)
+						return false;
+				}
+
+				next.clear();
+				for (auto c : open_[step + 1])
+				{
+					auto mines = fn_mines_before(c);
+					if (std::find(tile_constraints_[tile].begin(), tile_constraints_[tile].end(), c) != tile_constraints_[tile].end())
+						mines += value;
+					next.push_back(static_cast<char>(mines));
+				}
+				return true;
+			}
+
+			int TilesAfter(unsigned c, unsigned step) const
+			{
+				int tiles_after = 0;
+				for (auto tile : component_.constraints[c].tiles)
+					tiles_after += step_of_[tile] > step;
+				return tiles_after;
+			}
+
+			ProbabilityMap::Component& component_;
+			std::vector<std::vector<unsigned>> tile_constraints_;
+			std::vector<unsigned> order_;
+			std::vector<unsigned> step_of_;
+			std::vector<unsigned> first_step_;
+			std::vector<unsigned> last_step_;
+			std::vector<std::vector<unsigned>> open_;
+			std::vector<std::vector<State>> states_;
+		};
+
+		void CountComponent(ProbabilityMap::Component& component)
+		{
+			ComponentSolver solver(component);
+			if (!solver.Count())
+				solver.Sample(component.tiles.front());
+
+			// only the ratios between mine totals matter, scaled down so the combined weights stay in range
+			const auto largest = *std::max_element(component.layouts.begin(), component.layouts.end());
+			if (largest > 0)
+			{
+				for (auto& layouts : component.layouts)
+					layouts /= largest;
+				for (auto& tile_mines : component.tile_mines)
+					tile_mines /= largest;
+			}
+		}
+
+		// Distribution of the mine total of two independent parts, scaled so the largest weight is 1
+		std::vector<double> Convolve(const std::vector<double>& l, const std::vector<double>& r)
+		{
+			auto result = std::vector<double>(l.size() + r.size() - 1, 0);
+			for (auto i = 0u; i < l.size(); ++i)
+				for (auto j = 0u; j < r.size(); ++j)
+					result[i + j] += l[i] * r[j];
+
+			const auto largest = *std::max_element(result.begin(), result.end());
+			if (largest > 0)
+				for (auto& weight : result)
+					weight /= largest;
+
+			return result;
+		}
+	}
+
+	ProbabilityMap::ProbabilityMap(unsigned worker_count)
+		: worker_count_(std::max(worker_count, 1u))
+	{
+		for (auto i = 1u; i < worker_count_; ++i)
+			helpers_.emplace_back([this] { RunHelper(); });
+	}
+
+	ProbabilityMap::~ProbabilityMap()
+	{
+		{
+			std::lock_guard<std::mutex> lock(work_mutex_);
+			stopping_ = true;
+		}
+		work_wake_.notify_all();
+
+		for (auto& helper : helpers_)
+			helper.join();
+	}
+
+	void ProbabilityMap::Rebuild(const GameSession& session)
+	{
+		Analyse(session, nullptr);
+	}
+
+	void ProbabilityMap::Update(const GameSession& session, const ActionResult& result)
+	{
+		if (session.BoardSize().width != board_size_.width || session.BoardSize().height != board_size_.height)
+			return Rebuild(session);
+
+		// a component keeps its counts unless one of its tiles touches a cleared tile,
+		// a component that lost a tile to the sweep no longer matches its old tiles and is counted again as well
+		dirty_.assign(Size(board_size_), 0);
+		for (const auto& span : result.cleared)
+		{
+			const auto ybegin = span.row > 0 ? span.row - 1 : 0u;
+			const auto yend = std::min(span.row + 2, board_size_.height);
+			const auto xbegin = span.range.begin > 0 ? span.range.begin - 1 : 0u;
+			const auto xend = std::min(span.range.end + 1, board_size_.width);
+
+			for (auto y = ybegin; y < yend; ++y)
+				std::fill(dirty_.begin() + y * board_size_.width + xbegin, dirty_.begin() + y * board_size_.width + xend, 1);
+		}
+
+		Analyse(session, &dirty_);
+	}
+
+	double ProbabilityMap::ProbabilityAt(const Pos2D& position) const
+	{
+		if (position.x >= board_size_.width || position.y >= board_size_.height)
+			throw(std::out_of_range("Not on board!"));
+		return probabilities_[RowMajorLayout::Offset(board_size_, position)];
+	}
+
+	bool ProbabilityMap::IsExact() const
+	{
+		return std::none_of(components_.begin(), components_.end(), [](const Component& component) { return component.sampled; });
+	}
+
+	void ProbabilityMap::Analyse(const GameSession& session, const std::vector<std::uint8_t>* dirty)
+	{
+		board_size_ = session.BoardSize();
+		const auto& board = *session.GetBoard();
+		const auto& revealed = session.Revealed();
+		const auto tile_count = Size(board_size_);
+
+		// join the hidden neighbours of every revealed number
+		auto& parent = parent_;
+		parent.resize(tile_count);
+		std::iota(parent.begin(), parent.end(), 0u);
+		auto fn_find = [&](unsigned tile) {
+			while (parent[tile] != tile)
+				tile = parent[tile] = parent[parent[tile]];
+			return tile;
+		};
+
+		auto& frontier = frontier_;
+		frontier.assign(tile_count, 0);
+		auto& constraint_tiles = constraint_tiles_;
+		constraint_tiles.clear();
+		unsigned revealed_mines = 0;
+		unsigned hidden_tiles = 0;
+
+		// ProbabilityMap keeps its own state row-major, the session's bits are where the board's layout puts them
+		RowMajorLayout::ForEachPosition(board_size_, [&](const Pos2D& position, std::size_t offset) {
+			if (!revealed.Test(board.Offset(position)))
+			{
+				++hidden_tiles;
+				return;
+			}
+
+			const auto tile = board.TileAt(position);
+			if (tile == mine_value)
+			{
+				++revealed_mines;
+				return;
+			}
+			if (tile == 0)
+				return;
+
+			auto first = std::numeric_limits<unsigned>::max();
+			SquareTopology::ForEachNeighbour(board_size_, position, [&](const Pos2D& neighbour) {
+				const auto neighbour_offset = neighbour.y * board_size_.width + neighbour.x;
+				if (revealed.Test(board.Offset(neighbour)))
+					return;
+
+				frontier[neighbour_offset] = 1;
+				if (first == std::numeric_limits<unsigned>::max())
+					first = neighbour_offset;
+				else
+					parent[fn_find(neighbour_offset)] = fn_find(first);
+			});
+
+			if (first != std::numeric_limits<unsigned>::max())
+				constraint_tiles.push_back(static_cast<unsigned>(offset));
+		});
+
+		// group the frontier by root, tiles come out ascending
+		auto& old_components = previous_components_;
+		auto& old_component_of = previous_component_of_;
+		old_components.swap(components_);
+		old_component_of.swap(component_of_);
+		components_.clear();
+		component_of_.assign(tile_count, -1);
+		auto& local_index = local_index_;
+		local_index.resize(tile_count);
+
+		auto& root_component = root_component_;
+		root_component.assign(tile_count, -1);
+		for (auto offset = 0u; offset < tile_count; ++offset)
+		{
+			if (!frontier[offset])
+				continue;
+
+			auto& component = root_component[fn_find(offset)];
+			if (component < 0)
+			{
+				component = static_cast<int>(components_.size());
+				components_.emplace_back();
+			}
+			component_of_[offset] = component;
+			local_index[offset] = static_cast<unsigned>(components_[component].tiles.size());
+			components_[component].tiles.push_back(offset);
+		}
+
+		for (auto offset : constraint_tiles)
+		{
+			const auto position = Position2D(offset % board_size_.width, offset / board_size_.width);
+			Constraint constraint;
+			constraint.mines = board.TileAt(position);
+			int component = -1;
+
+			SquareTopology::ForEachNeighbour(board_size_, position, [&](const Pos2D& neighbour) {
+				const auto neighbour_offset = neighbour.y * board_size_.width + neighbour.x;
+				if (!revealed.Test(board.Offset(neighbour)))
+				{
+					constraint.tiles.push_back(local_index[neighbour_offset]);
+					component = component_of_[neighbour_offset];
+				}
+				else if (board.TileAt(neighbour) == mine_value)
+				{
+					--constraint.mines;
+				}
+			});
+
+			components_[component].constraints.push_back(std::move(constraint));
+		}
+
+		// take over the counts of components the action did not touch
+		auto& to_count = to_count_;
+		to_count.clear();
+		for (auto c = 0u; c < components_.size(); ++c)
+		{
+			auto& component = components_[c];
+			const bool touched = !dirty || std::any_of(component.tiles.begin(), component.tiles.end(), [&](unsigned offset) { return (*dirty)[offset]; });
+			const auto old = touched || old_component_of.size() != tile_count ? -1 : old_component_of[component.tiles.front()];
+
+			if (old >= 0 && old_components[old].tiles == component.tiles)
+			{
+				component.layouts = std::move(old_components[old].layouts);
+				component.tile_mines = std::move(old_components[old].tile_mines);
+				component.sampled = old_components[old].sampled;
+			}
+			else
+			{
+				to_count.push_back(c);
+			}
+		}
+
+		CountComponents(to_count);
+		last_counted_ = to_count.size();
+
+		const auto frontier_tiles = static_cast<unsigned>(std::count(frontier.begin(), frontier.end(), 1));
+		const auto mine_count = session.GetBoard()->MineCount();
+		const auto remaining_mines = mine_count > revealed_mines ? mine_count - revealed_mines : 0u;
+		Combine(remaining_mines, hidden_tiles - frontier_tiles, frontier, session);
+	}
+
+	void ProbabilityMap::CountComponents(const std::vector<std::size_t>& indices)
+	{
+		// the components are independent, hand them out to the helpers and count on this thread too
+		const auto tickets = static_cast<unsigned>(std::min<std::size_t>(helpers_.size(), indices.size() > 0 ? indices.size() - 1 : 0));
+		if (tickets == 0)
+		{
+			for (auto index : indices)
+				CountComponent(components_[index]);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(work_mutex_);
+			work_indices_ = &indices;
+			work_next_ = 0;
+			work_tickets_ = tickets;
+			busy_helpers_ = tickets;
+		}
+		if (tickets == helpers_.size())
+			work_wake_.notify_all();
+		else
+			for (auto i = 0u; i < tickets; ++i)
+				work_wake_.notify_one();
+
+		// the helpers must be done with indices before it goes away, even when counting here failed
+		std::exception_ptr error;
+		try
+		{
+			CountPending();
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		std::unique_lock<std::mutex> lock(work_mutex_);
+		work_done_.wait(lock, [this] { return busy_helpers_ == 0; });
+		work_indices_ = nullptr;
+
+		if (!error)
+			error = work_error_;
+		work_error_ = nullptr;
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	void ProbabilityMap::CountPending()
+	{
+		for (auto i = work_next_++; i < work_indices_->size(); i = work_next_++)
+			CountComponent(components_[(*work_indices_)[i]]);
+	}
+
+	void ProbabilityMap::RunHelper()
+	{
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(work_mutex_);
+				work_wake_.wait(lock, [this] { return stopping_ || work_tickets_ > 0; });
+				if (stopping_)
+					return;
+				--work_tickets_;
+			}
+
+			std::exception_ptr error;
+			try
+			{
+				CountPending();
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> lock(work_mutex_);
+			if (error && !work_error_)
+				work_error_ = error;
+			if (--busy_helpers_ == 0)
+				work_done_.notify_one();
+		}
+	}
+
+	void ProbabilityMap::Combine(unsigned remaining_mines, unsigned interior_tiles, const std::vector<std::uint8_t>& frontier, const GameSession& session)
+	{
+		const auto& board = *session.GetBoard();
+		const auto& revealed = session.Revealed();
+
+		probabilities_.assign(Size(board_size_), 0);
+
+		// mine totals of all components before each one
+		const auto count = components_.size();
+		auto before = std::vector<std::vector<double>>(count + 1);
+		before[0] = { 1 };
+		for (auto c = 0u; c < count; ++c)
+			before[c + 1] = Convolve(before[c], components_[c].layouts);
+		const auto& all = before[count];
+
+		// interior[f]: layouts of the interior when the frontier holds f mines, C(interior, remaining - f), relative to the
+		// largest of them. Only the totals the frontier can hold are needed, not every total of the board.
+		const auto fn_log_layouts = [&](unsigned mines) {
+			return std::lgamma(interior_tiles + 1.0) - std::lgamma(mines + 1.0) - std::lgamma(interior_tiles - mines + 1.0);
+		};
+		const auto fn_fits = [&](unsigned frontier_mines) { return frontier_mines <= remaining_mines && remaining_mines - frontier_mines <= interior_tiles; };
+		auto interior = std::vector<double>(all.size(), 0);
+		auto largest_log = -std::numeric_limits<double>::infinity();
+		for (auto frontier_mines = 0u; frontier_mines < all.size(); ++frontier_mines)
+		{
+			if (fn_fits(frontier_mines))
+				largest_log = std::max(largest_log, fn_log_layouts(remaining_mines - frontier_mines));
+		}
+		for (auto frontier_mines = 0u; frontier_mines < all.size(); ++frontier_mines)
+		{
+			if (fn_fits(frontier_mines))
+				interior[frontier_mines] = std::exp(fn_log_layouts(remaining_mines - frontier_mines) - largest_log);
+		}
+
+		// support[m]: how much the components after the current one and the interior together support m mines on the
+		// components up to it. Starts as the interior alone and takes in one component per step going backwards, so
+		// a component never needs the convolution of all the others. Scaled so the largest weight is 1.
+		auto support = interior;
+		auto next_support = std::vector<double>(all.size(), 0);
+
+		for (auto c = count; c > 0; --c)
+		{
+			const auto& component = components_[c - 1];
+			const auto& earlier = before[c - 1];
+			const auto tile_count = component.tiles.size();
+
+			// weight[k]: how much the rest of the board supports this component holding k mines
+			auto weight = std::vector<double>(component.layouts.size(), 0);
+			double total = 0;
+			for (auto k = 0u; k < weight.size(); ++k)
+			{
+				for (auto other = 0u; other < earlier.size(); ++other)
+					weight[k] += earlier[other] * support[k + other];
+				total += component.layouts[k] * weight[k];
+			}
+
+			// no mine total fits the mine count, which only a finished game can show: fall back to the component alone
+			if (total <= 0)
+			{
+				std::fill(weight.begin(), weight.end(), 1.0);
+				total = std::accumulate(component.layouts.begin(), component.layouts.end(), 0.0);
+			}
+
+			for (auto i = 0u; i < tile_count; ++i)
+			{
+				double mines = 0;
+				for (auto k = 0u; k < weight.size(); ++k)
+					mines += component.tile_mines[k * tile_count + i] * weight[k];
+				probabilities_[component.tiles[i]] = total > 0 ? mines / total : 0;
+			}
+
+			// only the totals the earlier components can reach are needed from here on
+			const auto reachable = earlier.size();
+			double largest = 0;
+			for (auto mines = 0u; mines < reachable; ++mines)
+			{
+				double supported = 0;
+				for (auto k = 0u; k < component.layouts.size(); ++k)
+					supported += component.layouts[k] * support[mines + k];
+				next_support[mines] = supported;
+				largest = std::max(largest, supported);
+			}
+			if (largest > 0)
+				for (auto mines = 0u; mines < reachable; ++mines)
+					next_support[mines] /= largest;
+
+			support.swap(next_support);
+		}
+
+		if (interior_tiles == 0)
+			return;
+
+		// expected mines off the frontier, spread evenly over its tiles
+		double total = 0;
+		double interior_mines = 0;
+		for (auto frontier_mines = 0u; frontier_mines < all.size(); ++frontier_mines)
+		{
+			const auto weight = all[frontier_mines] * interior[frontier_mines];
+			total += weight;
+			interior_mines += weight * (remaining_mines - std::min<unsigned>(frontier_mines, remaining_mines));
+		}
+
+		const auto interior_probability = total > 0 ? std::min(1.0, interior_mines / total / interior_tiles) : std::min(1.0, static_cast<double>(remaining_mines) / interior_tiles);
+		RowMajorLayout::ForEachPosition(board_size_, [&](const Pos2D& position, std::size_t offset) {
+			if (!frontier[offset] && !revealed.Test(board.Offset(position)))
+				probabilities_[offset] = interior_probability;
+		});
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#ifndef PROBABILITYMAP_H_
+#define PROBABILITYMAP_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Minesweep_Basics.h"
+#include "GameSession.h"
+
+namespace kms
+{
+	// Chance of a mine under every hidden tile, judged only by what the player can see: the revealed numbers and the
+	// mine count of the board. Flags are the player's guesses and are not trusted.
+	//
+	// Hidden tiles next to revealed numbers form the frontier. Tiles sharing a number depend on each other, so the frontier
+	// splits into independent components. Every component's mine layouts agreeing with its numbers are counted by mine total,
+	// then the components and the tiles away from the frontier are weighted against each other by the global mine count.
+	// Components too big to enumerate are sampled instead, then IsExact() is false.
+	// Components are counted on worker_count threads, the calling one and helpers started with the map.
+	class ProbabilityMap
+	{
+	public:
+		explicit ProbabilityMap(unsigned worker_count = std::thread::hardware_concurrency());
+		~ProbabilityMap();
+
+		ProbabilityMap(const ProbabilityMap&) = delete;
+		ProbabilityMap& operator=(const ProbabilityMap&) = delete;
+
+		// Analyse the session from scratch, needed first and after Undo or Redo
+		void Rebuild(const GameSession& session);
+
+		// Analyse the session again after result was applied to it, only components the cleared tiles touched are counted again
+		void Update(const GameSession& session, const ActionResult& result);
+
+		// 0 for revealed tiles. Throws std::out_of_range if the position is off the board, checked per axis
+		double ProbabilityAt(const Pos2D& position) const;
+		const std::vector<double>& Probabilities() const { return probabilities_; }	// row-major
+
+		std::size_t ComponentCount() const { return components_.size(); }
+		std::size_t LastCountedComponents() const { return last_counted_; }	// components counted by the last Rebuild or Update
+		bool IsExact() const;
+
+		struct Constraint
+		{
+			int mines = 0;					// mines still to place among the tiles
+			std::vector<unsigned> tiles;	// indices into Component::tiles
+		};
+
+		struct Component
+		{
+			std::vector<unsigned> tiles;		// offsets of the hidden tiles, ascending
+			std::vector<Constraint> constraints;
+			std::vector<double> layouts;		// [k] layouts with k mines, scaled
+			std::vector<double> tile_mines;		// [k * tiles.size() + i] of those, layouts with a mine on tile i
+			bool sampled = false;
+		};
+
+	private:
+		void Analyse(const GameSession& session, const std::vector<std::uint8_t>* dirty);
+		void CountComponents(const std::vector<std::size_t>& indices);
+		void CountPending();
+		void RunHelper();
+		void Combine(unsigned remaining_mines, unsigned interior_tiles, const std::vector<std::uint8_t>& frontier, const GameSession& session);
+
+		unsigned worker_count_;
+		Size2D board_size_{ 0, 0 };
+		std::vector<Component> components_;
+		std::vector<int> component_of_;		// by offset, -1 off the frontier
+		std::vector<double> probabilities_;
+		std::size_t last_counted_ = 0;
+
+		// per tile scratch of Analyse and Update, kept so an Update on a large board does not allocate it again
+		std::vector<unsigned> parent_;
+		std::vector<std::uint8_t> frontier_;
+		std::vector<std::uint8_t> dirty_;
+		std::vector<unsigned> local_index_;
+		std::vector<int> root_component_;
+		std::vector<unsigned> constraint_tiles_;
+		std::vector<std::size_t> to_count_;
+		std::vector<Component> previous_components_;
+		std::vector<int> previous_component_of_;
+
+		// worker_count - 1 helpers, CountComponents hands out one ticket per helper it wants and counts alongside them
+		std::vector<std::thread> helpers_;
+		std::mutex work_mutex_;
+		std::condition_variable work_wake_;
+		std::condition_variable work_done_;
+		const std::vector<std::size_t>* work_indices_ = nullptr;
+		std::atomic<std::size_t> work_next_{ 0 };
+		unsigned work_tickets_ = 0;
+		unsigned busy_helpers_ = 0;
+		std::exception_ptr work_error_;
+		bool stopping_ = false;
+	};
+}
+
+#endif // !PROBABILITYMAP_H_
@@ -10,88 +10,23 @@
 #include <algorithm>
 #include <cstdlib>
 #include <ctime>
+#include <fstream>
+#include <string>
+#include <thread>
 
 #include "Minesweep_Basics.h"
 #include "ScanlineSweep.h"
+#include "MineField.h"
+#include "ReplayLog.h"
+#include "GameServer.h"
+#include "LoadGenerator.h"
+#include "Benchmark.h"
+#include "SweepCheck.h"
+#include "HistoryCheck.h"
+#include "ProbabilityCheck.h"
 
 namespace kms
 {
-    int ReportNeighbouringMine(int value)
-    {
-        if (value < 0)
-            return value;
-
-        return value + 1;
-    }
-
-    template<class T_Itr>
-    void ReportMineOnNearbyRow(T_Itr nearest, bool left, bool right)
-    {
-        *nearest = ReportNeighbouringMine(*nearest);
-
-        if (left)
-            *(nearest - 1) = ReportNeighbouringMine(*(nearest - 1));
-
-        if (right)
-            *(nearest + 1) = ReportNeighbouringMine(*(nearest + 1));
-    }
-
-    template<class T_Itr>
-    void ReportMineOnCurrentRow(T_Itr curr, bool left, bool right)
-    {
-        *curr = mine_value;
-
-        if (left)
-            *(curr - 1) = ReportNeighbouringMine(*(curr - 1));
-
-        if (right)
-            *(curr + 1) = ReportNeighbouringMine(*(curr + 1));
-    }
-
-    std::vector<int> PlaceMines(const Size2D& board_size, unsigned int coverage)
-    {
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
-
-        const float percent_coef = 100.f / static_cast<float>(RAND_MAX);
-
-        std::vector<int> tiles(Size(board_size), 0);
-
-        for (auto y = 0u; y < board_size.height; ++y)
-        {
-            const bool top_neighbour = y > 0;
-            const bool bottom_neighbour = y < (board_size.height - 1);
-
-            for (auto x = 0u; x < board_size.width; ++x)
-            {
-                const bool left_neighbour = x > 0;
-                const bool right_neighbour = x < (board_size.width - 1);
-
-                const auto curr_tile_offset = y * board_size.width + x;
-
-                // determine whether to place a mine
-                auto rand = std::rand();
-                auto percent = rand * percent_coef;
-                bool place_mine = percent < coverage;
-
-                if (place_mine)
-                {
-                    auto itr_curr_tile = tiles.begin() + curr_tile_offset;
-
-                    ReportMineOnCurrentRow(itr_curr_tile, left_neighbour, right_neighbour);
-
-                    if (top_neighbour)
-                        ReportMineOnNearbyRow(itr_curr_tile - board_size.width, left_neighbour, right_neighbour);
-
-                    if (bottom_neighbour)
-                        ReportMineOnNearbyRow(itr_curr_tile + board_size.width, left_neighbour, right_neighbour);
-                }
-            }
-        }
-
-        return tiles;
-    }
-
-
     void PrintTile(int value, bool visited)
     {
         if (value == 0 && visited)
@@ -178,7 +113,7 @@ namespace kms
         return pos;
     }
 
-    void Play(const Size2D& board_size, const kms::TilesVector_t& tiles_data)
+    void Play(const Size2D& board_size, const kms::TilesVector_t& tiles_data, ReplayRecorder* recorder)
     {
         using tile_state_t = uint16_t;
 
@@ -215,6 +150,9 @@ namespace kms
         {
             auto position = GetPosition(board_size);
 
+            if (recorder)
+                recorder->Record(EReplayAction::reveal, position);
+
             ScanlineSweep(board_size, position, fn_get_tile_data, fn_clear_tile);
 
             auto tile_value = StepOnTile(board_size, position, tiles_data);
@@ -237,13 +175,81 @@ namespace kms
     }
 }
 
-int main()
+int main(int argc, char* argv[])
 {
-    kms::Size2D board_size = {16, 16};
+    const auto args = std::vector<std::string>(argv + 1, argv + argc);
 
-    const auto tiles = PlaceMines(board_size, 10);
+    // Prototype --replay <file>: run a recorded game headless and report the latency of every action
+    if (args.size() == 2 && args[0] == "--replay")
+    {
+        std::ifstream in(args[1], std::ios::binary);
+        const auto log = kms::ReadReplayLog(in);
+        kms::PrintReplayReport(std::cout, kms::RunReplay(log));
+        return 0;
+    }
 
-    Play(board_size, tiles);
-}
+    // Prototype --server <port> [workers]: host games for clients on localhost until the process is killed
+    if (args.size() >= 2 && args[0] == "--server")
+    {
+        const auto workers = args.size() >= 3 ? static_cast<unsigned>(std::stoul(args[2])) : std::thread::hardware_concurrency();
+        kms::GameServer server(workers);
+        std::cout << "Serving on port " << args[1] << " with " << server.WorkerCount() << " workers\n";
+        server.Serve(kms::Socket::Listen(static_cast<std::uint16_t>(std::stoul(args[1]))));
+        return 0;
+    }
 
+    // Prototype --loadgen <port> [connections] [sessions per connection] [reveals per session]: put load on a running server
+    if (args.size() >= 2 && args[0] == "--loadgen")
+    {
+        kms::LoadGeneratorOptions options;
+        options.port = static_cast<std::uint16_t>(std::stoul(args[1]));
+        if (args.size() >= 3)
+            options.connections = static_cast<unsigned>(std::stoul(args[2]));
+        if (args.size() >= 4)
+            options.sessions_per_connection = static_cast<unsigned>(std::stoul(args[3]));
+        if (args.size() >= 5)
+            options.reveals_per_session = static_cast<unsigned>(std::stoul(args[4]));
+
+        kms::PrintLoadReport(std::cout, kms::RunLoadGenerator(options));
+        return 0;
+    }
 
+    // Prototype --bench: compare the generation and reveal paths
+    if (args.size() == 1 && args[0] == "--bench")
+    {
+        kms::RunBenchmarks(std::cout);
+        return 0;
+    }
+
+    // Prototype --check: compare ScanlineSweep with a reference flood fill on many boards, build with KMS_SWEEP_STATS to also check its scanline count,
+    // compare torus and hex generation and sweeps with their own reference,
+    // undo and redo random games step by step against the states they went through, and compare the mine probabilities with
+    // every layout counted out on small boards
+    if (args.size() == 1 && args[0] == "--check")
+    {
+        const auto sweeps_passed = kms::RunSweepChecks(std::cout);
+        const auto topologies_passed = kms::RunTopologyChecks(std::cout);
+        const auto history_passed = kms::RunHistoryChecks(std::cout);
+        const auto probabilities_passed = kms::RunProbabilityChecks(std::cout);
+        return sweeps_passed && topologies_passed && history_passed && probabilities_passed ? 0 : 1;
+    }
+
+    kms::ReplayLog log;
+    log.board_size = {16, 16};
+    log.coverage = 10;
+    log.seed = static_cast<kms::Seed_t>(std::time(nullptr));
+
+    const auto tiles = kms::PlaceMines(log.board_size, log.coverage, log.seed);
+
+    // Prototype --record <file>: play as usual and write the game to a replay log when it is over
+    const bool record = args.size() == 2 && args[0] == "--record";
+    kms::ReplayRecorder recorder(log);
+
+    Play(log.board_size, tiles, record ? &recorder : nullptr);
+
+    if (record)
+    {
+        std::ofstream out(args[1], std::ios::binary);
+        kms::WriteReplayLog(out, log);
+    }
+}
@@ -0,0 +1,208 @@
+
+#include "ReplayLog.h"
+#include "GameSession.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace kms
+{
+	namespace
+	{
+		const char replay_magic[4] = { 'K', 'M', 'S', 'R' };
+		const std::uint8_t replay_version = 1;
+
+		// same limit as the game server, a log must not make RunReplay allocate more than a game could
+		const std::uint64_t max_replay_tiles = 4096u * 4096u;
+
+		void WriteVarint(std::ostream& out, std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.put(static_cast<char>((value & 0x7F) | 0x80));
+				value >>= 7;
+			}
+			out.put(static_cast<char>(value));
+		}
+
+		std::uint64_t ReadVarint(std::istream& in)
+		{
+			std::uint64_t value = 0;
+			for (unsigned shift = 0; shift < 64; shift += 7)
+			{
+				const auto byte = in.get();
+				if (byte == std::istream::traits_type::eof())
+					throw(std::runtime_error("Replay log ends unexpectedly!"));
+
+				value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+					return value;
+			}
+			throw(std::runtime_error("Malformed varint in replay log!"));
+		}
+
+		unsigned ReadUnsigned(std::istream& in)
+		{
+			const auto value = ReadVarint(in);
+			if (value > 0xFFFFFFFFull)
+				throw(std::runtime_error("Value out of range in replay log!"));
+			return static_cast<unsigned>(value);
+		}
+
+		std::chrono::nanoseconds Percentile(const std::vector<std::chrono::nanoseconds>& sorted, unsigned percent)
+		{
+			if (sorted.empty())
+				return std::chrono::nanoseconds{ 0 };
+
+			const auto index = (sorted.size() - 1) * percent / 100;
+			return sorted[index];
+		}
+	}
+
+	void WriteReplayLog(std::ostream& out, const ReplayLog& log)
+	{
+		out.write(replay_magic, sizeof(replay_magic));
+		out.put(static_cast<char>(replay_version));
+		WriteVarint(out, log.seed);
+		WriteVarint(out, log.coverage);
+		WriteVarint(out, log.board_size.width);
+		WriteVarint(out, log.board_size.height);
+		WriteVarint(out, log.events.size());
+
+		for (const auto& event : log.events)
+		{
+			WriteVarint(out, (static_cast<std::uint64_t>(event.delay_us) << 2) | static_cast<std::uint64_t>(event.action));
+			WriteVarint(out, event.position.x);
+			WriteVarint(out, event.position.y);
+		}
+	}
+
+	ReplayLog ReadReplayLog(std::istream& in)
+	{
+		char magic[sizeof(replay_magic)] = {};
+		in.read(magic, sizeof(magic));
+		if (!in || !std::equal(std::begin(magic), std::end(magic), std::begin(replay_magic)))
+			throw(std::runtime_error("Not a replay log!"));
+
+		if (in.get() != replay_version)
+			throw(std::runtime_error("Unsupported replay log version!"));
+
+		ReplayLog log;
+		log.seed = ReadVarint(in);
+		log.coverage = ReadUnsigned(in);
+		log.board_size.width = ReadUnsigned(in);
+		log.board_size.height = ReadUnsigned(in);
+
+		if (log.board_size.width == 0 || log.board_size.height == 0 ||
+			static_cast<std::uint64_t>(log.board_size.width) * log.board_size.height > max_replay_tiles || log.coverage > 100)
+			throw(std::runtime_error("Invalid board in replay log!"));
+
+		const auto event_count = ReadVarint(in);
+		for (auto i = decltype(event_count){0}; i < event_count; ++i)
+		{
+			const auto delay_and_action = ReadVarint(in);
+			if ((delay_and_action & 0x3) > static_cast<std::uint64_t>(EReplayAction::chord) || (delay_and_action >> 2) > 0xFFFFFFFFull)
+				throw(std::runtime_error("Invalid event in replay log!"));
+
+			ReplayEvent event;
+			event.action = static_cast<EReplayAction>(delay_and_action & 0x3);
+			event.delay_us = static_cast<std::uint32_t>(delay_and_action >> 2);
+			event.position.x = ReadUnsigned(in);
+			event.position.y = ReadUnsigned(in);
+			if (event.position.x >= log.board_size.width || event.position.y >= log.board_size.height)
+				throw(std::runtime_error("Event off the board in replay log!"));
+
+			log.events.push_back(event);
+		}
+
+		return log;
+	}
+
+	ReplayRecorder::ReplayRecorder(ReplayLog& log)
+		: log_(log)
+		, last_event_(std::chrono::steady_clock::now())
+	{
+	}
+
+	void ReplayRecorder::Record(EReplayAction action, const Pos2D& position)
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const auto delay = std::chrono::duration_cast<std::chrono::microseconds>(now - last_event_).count();
+		last_event_ = now;
+
+		ReplayEvent event;
+		event.action = action;
+		event.position = position;
+		event.delay_us = static_cast<std::uint32_t>(std::min<decltype(delay)>(delay, 0xFFFFFFFF));
+		log_.events.push_back(event);
+	}
+
+	ReplayReport RunReplay(const ReplayLog& log)
+	{
+		GameSession session(std::make_shared<const Board>(log.board_size, log.coverage, log.seed));
+
+		auto latencies = std::vector<std::chrono::nanoseconds>{};
+		latencies.reserve(log.events.size());
+
+		ReplayReport report;
+
+		for (const auto& event : log.events)
+		{
+			const auto begin = std::chrono::steady_clock::now();
+
+			ActionResult result;
+			switch (event.action)
+			{
+			case EReplayAction::reveal:
+				result = session.Reveal(event.position);
+				break;
+			case EReplayAction::flag:
+				session.ToggleFlag(event.position);
+				break;
+			case EReplayAction::chord:
+				result = session.Chord(event.position);
+				break;
+			}
+
+			latencies.push_back(std::chrono::steady_clock::now() - begin);
+
+			for (const auto& span : result.cleared)
+				report.tiles_revealed += span.range.end - span.range.begin;
+		}
+
+		report.actions = latencies.size();
+		for (const auto& latency : latencies)
+			report.total += latency;
+
+		std::sort(latencies.begin(), latencies.end());
+		report.p50 = Percentile(latencies, 50);
+		report.p90 = Percentile(latencies, 90);
+		report.p99 = Percentile(latencies, 99);
+		report.max = latencies.empty() ? std::chrono::nanoseconds{ 0 } : latencies.back();
+
+		report.state_checksum = 0xCBF29CE484222325ull;
+		for (auto y = 0u; y < log.board_size.height; ++y)
+		{
+			for (auto x = 0u; x < log.board_size.width; ++x)
+			{
+				report.state_checksum ^= static_cast<std::uint64_t>(session.StateAt(Position2D(x, y)));
+				report.state_checksum *= 0x100000001B3ull;
+			}
+		}
+		report.mine_hit = session.IsGameOver();
+
+		return report;
+	}
+
+	void PrintReplayReport(std::ostream& out, const ReplayReport& report)
+	{
+		out << "Actions:        " << report.actions << '\n'
+			<< "Total:          " << report.total.count() << " ns\n"
+			<< "p50:            " << report.p50.count() << " ns\n"
+			<< "p90:            " << report.p90.count() << " ns\n"
+			<< "p99:            " << report.p99.count() << " ns\n"
+			<< "max:            " << report.max.count() << " ns\n"
+			<< "Tiles revealed: " << report.tiles_revealed << '\n'
+			<< "Mine hit:       " << (report.mine_hit ? "yes" : "no") << '\n'
+			<< "State checksum: " << std::hex << report.state_checksum << std::dec << '\n';
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef REPLAYLOG_H_
+#define REPLAYLOG_H_
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "Minesweep_Basics.h"
+#include "MineField.h"
+
+namespace kms
+{
+	enum class EReplayAction : std::uint8_t
+	{
+		reveal,
+		flag,
+		chord
+	};
+
+	struct ReplayEvent
+	{
+		EReplayAction action = EReplayAction::reveal;
+		Pos2D position;
+		std::uint32_t delay_us = 0;	// time since the previous event
+	};
+
+	// Everything needed to play a game again, the board is regenerated from the seed
+	struct ReplayLog
+	{
+		Seed_t seed = 0;
+		unsigned coverage = 0;
+		Size2D board_size;
+		std::vector<ReplayEvent> events;
+	};
+
+	// Binary format: "KMSR", version byte, then LEB128 varints for seed, coverage, width, height and the event count,
+	// followed by one varint per event for (delay_us << 2 | action) and one each for x and y
+	void WriteReplayLog(std::ostream& out, const ReplayLog& log);
+
+	// Throws std::runtime_error if the stream does not hold a valid log, including boards without tiles, of more than
+	// 4096x4096 tiles or with a coverage above 100 and events off the board
+	ReplayLog ReadReplayLog(std::istream& in);
+
+	// Appends events to a log while a game is being played live
+	class ReplayRecorder
+	{
+	public:
+		explicit ReplayRecorder(ReplayLog& log);
+
+		void Record(EReplayAction action, const Pos2D& position);
+
+	private:
+		ReplayLog& log_;
+		std::chrono::steady_clock::time_point last_event_;
+	};
+
+	struct ReplayReport
+	{
+		std::size_t actions = 0;
+		std::chrono::nanoseconds total{ 0 };
+		std::chrono::nanoseconds p50{ 0 };
+		std::chrono::nanoseconds p90{ 0 };
+		std::chrono::nanoseconds p99{ 0 };
+		std::chrono::nanoseconds max{ 0 };
+		std::size_t tiles_revealed = 0;
+		std::uint64_t state_checksum = 0;	// FNV-1a over the final tile states, equal checksums mean the replays ended identically
+		bool mine_hit = false;
+	};
+
+	// Regenerate the board and run every event as fast as possible, ignoring the recorded delays
+	ReplayReport RunReplay(const ReplayLog& log);
+
+	void PrintReplayReport(std::ostream& out, const ReplayReport& report);
+}
+
+#endif // !REPLAYLOG_H_
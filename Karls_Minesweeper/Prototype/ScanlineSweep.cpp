@@ -1,5 +1,6 @@
 
 #include "ScanlineSweep.h"
+#include "SweepStats.h"
 #include <algorithm>
 #include <cmath>
 #include <functional>
@@ -7,13 +8,6 @@
 
 namespace kms
 {
-	enum class ELineFeed
-	{
-		undefiend,
-		up,
-		down
-	};
-
 	ELineFeed OppositeFeedDirection(ELineFeed feed)
 	{
 		switch (feed)
@@ -22,8 +16,9 @@ namespace kms
 			return ELineFeed::down;
 		case kms::ELineFeed::down:
 			return ELineFeed::up;
+		default:
+			return ELineFeed::undefiend;
 		}
-		return ELineFeed::undefiend;
 	}
 
 	enum class ETileStatus
@@ -32,13 +27,6 @@ namespace kms
 		cleared
 	};
 
-	struct ScanLine
-	{
-		Pos2D start_position;
-		unsigned magnitude = 0;
-		ELineFeed feed = ELineFeed::undefiend;
-	};
-
 	ScanLine CreateScanLine(const Pos2D& start_position, unsigned magnitude, ELineFeed feed, const Size2D& board_size)
 	{
 		if (start_position.x >= board_size.width || start_position.y >= board_size.height || start_position.x + magnitude > board_size.width)
@@ -59,7 +47,7 @@ namespace kms
 		const auto bx2 = b.start_position.x + b.magnitude;
 
 		return a.start_position.y == b.start_position.y &&
-			((ax1 <= bx1 && bx1 <= ax2) || (ax1 <= bx2 && bx2 <= ax1) || (ax1 <= bx1 && bx2 >= ax2) || (bx1 <= ax1 && ax2 >= bx2));
+			((ax1 <= bx1 && bx1 <= ax2) || (ax1 <= bx2 && bx2 <= ax2) || (ax1 <= bx1 && bx2 >= ax2) || (bx1 <= ax1 && ax2 >= bx2));
 	}
 
 	void CacheScanline(const ScanLine& scan_line, const Size2D& board_size, std::function<void(const ScanLine&)> fn_cache_scanline)
@@ -100,134 +88,61 @@ namespace kms
 	}
 
 
-	// Adjust the start of the scanline to hit the next hot tile, or first tile of the row to the right of the start_position 
-	// cache any scanline that results from a possible expansion to the left
-	ScanLine AdjustScanlineStart(const ScanLine& scanline, const Size2D& board_size, 
-		std::function<int(const Pos2D&)> fn_get_tile_data, 
-		std::function<void(const ScanLine&)> fn_cache)
+	// Extend a run of blank tiles to the left of run_position, clearing tiles until a hot tile (which is cleared too),
+	// the border or an already cleared tile is hit. Returns the x position of the leftmost blank tile of the run.
+	unsigned AdjustScanlineStart(const Pos2D& run_position,
+		std::function<int(Pos2D)> fn_get_tile_data,
+		std::function<bool(const Pos2D&)> fn_clear_tile_at)
 	{
-		auto is_tile_hot_at = [&](const Pos2D& position) { return fn_get_tile_data(position); };
-
-		// start position is not at the start of the row and the tile value is cold tile (zero value)
-		// expand scanline to the left until it hits (and includes) the next hot tile (non-zero value) 
-		// or until the beginning of the row is hit.
-
-		// also record the next_scanline starting at the new start position and have a magnitude equal
-		// to the old_start_position - new_start_position.
-
-
-		if (scanline.magnitude > 1 && scanline.feed != ELineFeed::undefiend)
+		auto position = run_position;
+		while (position.x > 0)
 		{
-			bool shrink = false;
-			shrink = is_tile_hot_at(Position2D(scanline.start_position.x + 1, scanline.start_position.y));
-			if (scanline.start_position.x != 0 && scanline.start_position.x < board_size.width)
-			{
-				if (scanline.feed == ELineFeed::up)
-					shrink = shrink && is_tile_hot_at(Position2D(scanline.start_position.x, scanline.start_position.y -1));
-				else if (scanline.feed == ELineFeed::up)
-					shrink = shrink && is_tile_hot_at(Position2D(scanline.start_position.x, scanline.start_position.y +1));
-			}
+			const auto next_position = Position2D(position.x - 1, position.y);
 
-			if (shrink)
-			{
-				auto shrunk_scanline = scanline;
-				shrunk_scanline.start_position.x += 1;
-				shrunk_scanline.magnitude - 1;
-				return shrunk_scanline;
-			}
-		}
+			// cleared by an earlier scanline which also took care of its neighbours
+			if (!fn_clear_tile_at(next_position))
+				break;
 
+			KMS_SWEEP_STAT(++detail::CurrentSweepStats().tiles_cleared);
 
-		auto adjusted_scanline = scanline;
-		auto extension_magnitude = decltype(scanline.magnitude){0};
-		for (; adjusted_scanline.start_position.x > 0; --adjusted_scanline.start_position.x)
-		{
-			// if tile value is hot
-			if (is_tile_hot_at(adjusted_scanline.start_position))
+			if (fn_get_tile_data(next_position) != 0)
 				break;
-		}
 
-		extension_magnitude = scanline.start_position.x - adjusted_scanline.start_position.x;
-		
-		if (extension_magnitude && adjusted_scanline.feed != ELineFeed::undefiend)
-			CacheScanLine_NextRow_ReverseFeed(adjusted_scanline.start_position, extension_magnitude, adjusted_scanline.feed, board_size, fn_cache);
+			position = next_position;
+		}
 
-		adjusted_scanline.magnitude += extension_magnitude;
-		return adjusted_scanline;
+		return position.x;
 	}
 
-	// Adjust the scanlines magnitude possibly extending it to the right cache any scanlines that may result from this
-	ScanLine AdjustScanlineMagnitude(const ScanLine& scanline, const Size2D& board_size,
-			std::function<int(const Pos2D&)> fn_get_tile_data,
-			std::function<void(const ScanLine&)> fn_cache)
+	// Extend a run of blank tiles to the right of run_position, same rules as AdjustScanlineStart.
+	// Returns the x position of the rightmost blank tile of the run.
+	unsigned AdjustScanlineMagnitude(const Pos2D& run_position, const Size2D& board_size,
+		std::function<int(Pos2D)> fn_get_tile_data,
+		std::function<bool(const Pos2D&)> fn_clear_tile_at)
 	{
-		auto is_tile_hot_at = [&](const Pos2D& position) { return fn_get_tile_data(position); };
-
-		auto pos_last_tile_of_scanline = Position2D(scanline.start_position.x + scanline.magnitude - 1, scanline.start_position.y);
-
-		// check if the scanline magnitude should shrink
-		if (scanline.magnitude > 1 && scanline.feed != ELineFeed::undefiend)
+		auto position = run_position;
+		while (position.x + 1 < board_size.width)
 		{
-			bool shrink = false;
-			const auto xpos_at_last_tile_of_row = board_size.width -1;
-			const auto xpos_last_tile_of_scanline = scanline.start_position.x + scanline.magnitude - 1;
-			
-			//if (is_tile_hot_at(Position2D(xpos_last_tile_of_scanline, scanline.start_position.y)) == false)
-			//{
-				shrink = is_tile_hot_at(Position2D(xpos_last_tile_of_scanline -1, scanline.start_position.y));
-
-				// if the last tile of the scanline is not the last tile of the row
-				if (xpos_last_tile_of_scanline == xpos_at_last_tile_of_row)
-				{
-					// also check the last tile on the previous row
-					if (scanline.feed == ELineFeed::up)
-						shrink = shrink && is_tile_hot_at(Position2D(xpos_last_tile_of_scanline, scanline.start_position.y - 1));
-					else if (scanline.feed == ELineFeed::down)
-						shrink = shrink && is_tile_hot_at(Position2D(xpos_last_tile_of_scanline, scanline.start_position.y + 1));
-				}
-			//}
-			
-			if (shrink)
-			{
-				auto shrunk_scanline = scanline;
-				shrunk_scanline.magnitude -= 1; // shrink by one
-				return shrunk_scanline;
-			}
-		}
+			const auto next_position = Position2D(position.x + 1, position.y);
 
-		auto adjusted_scanline = scanline;
-		auto extension_magnitude = decltype(scanline.magnitude){0};
-		const auto beginning_of_extension = adjusted_scanline.start_position.x + adjusted_scanline.magnitude;
-		auto curr_position = adjusted_scanline.start_position;
-		curr_position.x = beginning_of_extension;
-		for (; curr_position.x < board_size.width; ++extension_magnitude, ++curr_position.x)
-		{
-			if (is_tile_hot_at(curr_position))
-			{
-				++extension_magnitude;
+			if (!fn_clear_tile_at(next_position))
 				break;
-			}
-		}
 
-		if (extension_magnitude && adjusted_scanline.feed != ELineFeed::undefiend)
-		{
-			auto position_first_tile_of_extension = adjusted_scanline.start_position;
-			position_first_tile_of_extension.x = beginning_of_extension;
-			CacheScanLine_NextRow_ReverseFeed(position_first_tile_of_extension, extension_magnitude, adjusted_scanline.feed, board_size, fn_cache);
-		}
+			KMS_SWEEP_STAT(++detail::CurrentSweepStats().tiles_cleared);
 
-		adjusted_scanline.magnitude += extension_magnitude;
-		return adjusted_scanline;
-	}
+			if (fn_get_tile_data(next_position) != 0)
+				break;
 
-	bool IsMagnitudeAdjustible(const ScanLine& scanline, const Size2D& board_size, std::function<bool(Pos2D)> fn_get_tile_data)
-	{
-		auto is_not_last_tile_in_row = [&]() { return scanline.start_position.x + scanline.magnitude - 1 < board_size.width; };
-		auto is_last_tile_blank = [&]() { return fn_get_tile_data({ scanline.start_position.x + scanline.magnitude - 1, scanline.start_position.y }) == 0;  };
+			position = next_position;
+		}
 
-		return scanline.magnitude != 0 && is_not_last_tile_in_row() && is_last_tile_blank();
+		return position.x;
 	}
 
+	// Clear every tile of the scanline. The tiles of a scanline all neighbour a blank tile on the row it was fed from, so they are
+	// cleared whatever their value, but only a blank tile starts a run that is extended along the row and fed to the next rows.
+	// The row the scanline was fed from is already handled over the scanline's range, so only the parts of a run that reach
+	// beyond that range are fed back in the reverse direction.
 	void SweepOneScanLine(const ScanLine& scanline,
 		const Size2D& board_size,
 		std::function<int(Pos2D)> fn_get_tile_data,
@@ -236,87 +151,82 @@ namespace kms
 	{
 		// Simplifying function calls for better readability
 		auto cache = [&](const ScanLine& scan_line) { CacheScanline(scan_line, board_size, fn_cache_scanline); };
-		auto create_scanline = [&](const Pos2D& start_position, unsigned magnitude, ELineFeed line_feed) { return CreateScanLine(start_position, magnitude, line_feed, board_size); };
-		auto is_start_adjustible = [&](const ScanLine& scanline) { return fn_get_tile_data(scanline.start_position) == 0 && scanline.start_position.x != 0; };
-		auto is_magnitude_adjustible = [&](const ScanLine& scanline) { return IsMagnitudeAdjustible(scanline, board_size, fn_get_tile_data); };
 		auto is_hot = [&](const Pos2D& position) { return fn_get_tile_data(position) != 0; };
-	
 
-		// ADJUST THE START OF THE SCANLINE
-		// check the value of the starting tile,
+		const auto xbegin_of_scanline = scanline.start_position.x;
+		const auto xend_of_scanline = scanline.start_position.x + scanline.magnitude;
+		KMS_SWEEP_STAT(bool aborted = false);
 
-		// if the value is zero (not hot) then
-		// scan left until the first hot tile
-		// put the new start at the scanline at
-		// that tile.
-
-		// also put cleared_range to start at the
-		// same tile
-
-		auto adjusted_scanline = scanline;
-	
-		// Adjust start
-		if (is_start_adjustible(scanline))
-			adjusted_scanline = AdjustScanlineStart(adjusted_scanline, board_size, fn_get_tile_data, cache);
-
-		// Adjust magnitude
-		if (is_magnitude_adjustible(adjusted_scanline))
-			adjusted_scanline = AdjustScanlineMagnitude(adjusted_scanline, board_size, fn_get_tile_data, cache);
-
-		bool recording = true;
-		bool reset = false;
-		auto next_scanline = adjusted_scanline;
-		next_scanline.magnitude = 0;
-		const auto xend_of_scanline = adjusted_scanline.start_position.x + adjusted_scanline.magnitude;
-
-		// Scan the the scanline
-		for (auto curr_position = adjusted_scanline.start_position; curr_position.x < xend_of_scanline; ++curr_position.x, ++next_scanline.magnitude)
+		for (auto curr_position = scanline.start_position; curr_position.x < xend_of_scanline; ++curr_position.x)
 		{
-			// clear the tile at the curren position, if this function return false the tile has already been cleared
-			// so the next scanline should be aborted
-			if (fn_clear_tile_at(curr_position))
+			// if this function returns false the tile has already been cleared, and whoever cleared it handles its neighbours
+			if (!fn_clear_tile_at(curr_position))
 			{
-				if (reset)
-				{
-					next_scanline.start_position = curr_position;
-					next_scanline.magnitude = 1;
-					reset = false;
-				}
-
-				if (is_hot(curr_position) || curr_position.x == board_size.width -1)
-				{ 
-					if (recording)
-					{
-						if(next_scanline.magnitude) // not allowing
-						{ 
-							++next_scanline.magnitude; // one beyond the hot tile
-							CacheScanLine_NextRow(next_scanline, board_size, cache);
-						}
-						reset = false;
-						recording = false;
-					}
-
-					next_scanline.start_position = curr_position;
-					next_scanline.magnitude = 0;
-				}
-				else if(reset == false && recording == false)
-				{
-					recording = true;
-				}
+				KMS_SWEEP_STAT(aborted = true);
+				continue;
 			}
-			else
+
+			KMS_SWEEP_STAT(++detail::CurrentSweepStats().tiles_cleared);
+
+			if (is_hot(curr_position))
+				continue;
+
+			const auto xrun_first = AdjustScanlineStart(curr_position, fn_get_tile_data, fn_clear_tile_at);
+			const auto xrun_last = AdjustScanlineMagnitude(curr_position, board_size, fn_get_tile_data, fn_clear_tile_at);
+
+			KMS_SWEEP_STAT(if (xrun_first < xbegin_of_scanline) ++detail::CurrentSweepStats().start_extended);
+			KMS_SWEEP_STAT(if (xrun_last >= xend_of_scanline) ++detail::CurrentSweepStats().magnitude_extended);
+
+			// the blank run and the tiles diagonal to its ends
+			const auto xbegin_of_next = xrun_first > 0 ? xrun_first - 1 : 0u;
+			const auto xend_of_next = std::min(xrun_last + 2, board_size.width);
+
+			CacheScanLine_NextRow(Position2D(xbegin_of_next, curr_position.y), xend_of_next - xbegin_of_next, scanline.feed, board_size, cache);
+
+			if (scanline.feed != ELineFeed::undefiend)
 			{
-				recording = false;
-				reset = true;
+				if (xbegin_of_next < xbegin_of_scanline)
+					CacheScanLine_NextRow_ReverseFeed(Position2D(xbegin_of_next, curr_position.y), xbegin_of_scanline - xbegin_of_next, scanline.feed, board_size, cache);
+
+				if (xend_of_next > xend_of_scanline)
+					CacheScanLine_NextRow_ReverseFeed(Position2D(xend_of_scanline, curr_position.y), xend_of_next - xend_of_scanline, scanline.feed, board_size, cache);
 			}
+
+			// the tile after the run is either cleared by now or handled by whoever cleared it
+			curr_position.x = xrun_last + 1;
 		}
+
+		KMS_SWEEP_STAT(if (aborted) ++detail::CurrentSweepStats().scanlines_aborted);
+	}
+
+	SweepWorkspace::SweepWorkspace(std::pmr::memory_resource* resource)
+		: unhandled_scanlines(resource)
+	{
 	}
 
 	void ScanlineSweep(const Size2D& board_size, const Pos2D& start_position,
 		std::function<int(Pos2D)> fn_get_tile_data, std::function<bool(Pos2D)> fn_clear_tile)
 	{
-		auto unhandled_scanlines = std::vector <ScanLine>{};
-		auto fn_cache_scanline = [&](const ScanLine& scanline) { unhandled_scanlines.push_back(scanline); };
+		auto workspace = SweepWorkspace{};
+		ScanlineSweep(board_size, start_position, fn_get_tile_data, fn_clear_tile, workspace);
+	}
+
+	void ScanlineSweep(const Size2D& board_size, const Pos2D& start_position,
+		std::function<int(Pos2D)> fn_get_tile_data, std::function<bool(Pos2D)> fn_clear_tile, SweepWorkspace& workspace)
+	{
+		if (start_position.x >= board_size.width || start_position.y >= board_size.height)
+			throw(std::out_of_range("Not on board!"));
+
+		KMS_SWEEP_STAT(detail::SweepStatsScope stats_scope(start_position));
+
+		auto& unhandled_scanlines = workspace.unhandled_scanlines;
+		unhandled_scanlines.clear();
+		auto fn_cache_scanline = [&](const ScanLine& scanline) {
+			unhandled_scanlines.push_back(scanline);
+			KMS_SWEEP_STAT(auto& stats = detail::CurrentSweepStats());
+			KMS_SWEEP_STAT(++stats.scanlines_cached);
+			KMS_SWEEP_STAT(stats.max_stack_depth = std::max(stats.max_stack_depth, static_cast<unsigned>(unhandled_scanlines.size())));
+		};
 
 		// create the first scanline to start with
 		auto starting_scanline = ScanLine{};
@@ -324,7 +234,7 @@ namespace kms
 		starting_scanline.magnitude = 1; // one tile
 
 		// simplify calling to sweep
-		auto sweep = [&](const ScanLine& scanline) { SweepOneScanLine(scanline, board_size, fn_get_tile_data, fn_clear_tile, fn_cache_scanline); };
+		auto sweep = [&](const ScanLine& scanline) { KMS_SWEEP_STAT(++detail::CurrentSweepStats().scanlines_swept); SweepOneScanLine(scanline, board_size, fn_get_tile_data, fn_clear_tile, fn_cache_scanline); };
 
 		// sweep the first line
 		sweep(starting_scanline);
@@ -4,13 +4,39 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory_resource>
+#include <vector>
 #include "Minesweep_Basics.h"
 
 namespace kms
 {
+	enum class ELineFeed
+	{
+		undefiend,
+		up,
+		down
+	};
+
+	struct ScanLine
+	{
+		Pos2D start_position;
+		unsigned magnitude = 0;
+		ELineFeed feed = ELineFeed::undefiend;
+	};
+
+	// Scanline stack kept between sweeps, so a caller sweeping many times allocates it once and from the memory resource of its choice
+	struct SweepWorkspace
+	{
+		explicit SweepWorkspace(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		std::pmr::vector<ScanLine> unhandled_scanlines;
+	};
+
 	// Starting from a start position that has a zero value, sweep all the connected tiles that have a value of zero, and stop at either a border or a number (greater than zero)
 	// For each cleared line call the provieded function object and pass the cleared range to it
+	// Built with KMS_SWEEP_STATS the counters of the sweep can be read with LastSweepStats() afterwards, see SweepStats.h
 	void ScanlineSweep(const Size2D& board_size, const Pos2D& start_position, std::function<int(Pos2D)> fn_get_tile_data, std::function<bool(Pos2D)> fn_clear_tile);
+	void ScanlineSweep(const Size2D& board_size, const Pos2D& start_position, std::function<int(Pos2D)> fn_get_tile_data, std::function<bool(Pos2D)> fn_clear_tile, SweepWorkspace& workspace);
 }
 
 #endif // !SCANLINEFILL_H_
@@ -0,0 +1,42 @@
+
+// libFuzzer entry point for ScanlineSweep, not part of the Prototype build. Build it with clang, for example:
+//   clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined -DKMS_SWEEP_STATS ScanlineSweepFuzz.cpp SweepCheck.cpp ScanlineSweep.cpp SweepStats.cpp MineField.cpp Minesweep_Basics.cpp -o ScanlineSweepFuzz
+//
+// Input: width byte, height byte, coverage byte, 8 seed bytes, then an x and a y byte per click.
+// Any difference to the reference flood fill aborts with the case printed.
+
+#include "SweepCheck.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+	const std::size_t header_size = 3 + 8;
+	if (size < header_size)
+		return 0;
+
+	const auto board_size = kms::Size2D{ 1u + data[0] % 64u, 1u + data[1] % 64u };
+	const auto coverage = data[2] % 101u;
+
+	auto seed = kms::Seed_t{ 0 };
+	for (auto i = 0; i < 8; ++i)
+		seed = (seed << 8) | data[3 + i];
+
+	auto clicks = std::vector<kms::Pos2D>{};
+	for (auto i = header_size; i + 1 < size && clicks.size() < 16; i += 2)
+		clicks.push_back(kms::Position2D(data[i] % board_size.width, data[i + 1] % board_size.height));
+
+	if (clicks.empty())
+		clicks.push_back(kms::Position2D(0, 0));
+
+	const auto failure = kms::CheckSweep(board_size, coverage, seed, clicks);
+	if (!failure.empty())
+	{
+		std::fprintf(stderr, "%s\n", failure.c_str());
+		std::abort();
+	}
+
+	return 0;
+}
@@ -0,0 +1,249 @@
+
+#include "Socket.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <cerrno>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace kms
+{
+	namespace
+	{
+#ifdef _WIN32
+		using native_socket_t = SOCKET;
+		const auto shutdown_both = SD_BOTH;
+
+		void CloseNative(native_socket_t handle) { closesocket(handle); }
+
+		void EnsureStarted()
+		{
+			static const bool started = [] {
+				WSADATA data;
+				if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+					throw(std::runtime_error("WSAStartup failed!"));
+				return true;
+			}();
+			(void)started;
+		}
+#else
+		using native_socket_t = int;
+		const auto shutdown_both = SHUT_RDWR;
+
+		void CloseNative(native_socket_t handle) { close(handle); }
+
+		void EnsureStarted() {}
+#endif
+
+		// Whether the accept that just failed could succeed when tried again, false when the listening socket is gone
+		bool AcceptMayRecover()
+		{
+#ifdef _WIN32
+			switch (WSAGetLastError())
+			{
+			case WSAEINTR:
+			case WSAECONNRESET:
+			case WSAEMFILE:
+			case WSAENOBUFS:
+			case WSAEWOULDBLOCK:
+				return true;
+			default:
+				return false;
+			}
+#else
+			switch (errno)
+			{
+			case EINTR:
+			case ECONNABORTED:
+			case EPROTO:
+			case EMFILE:
+			case ENFILE:
+			case ENOBUFS:
+			case ENOMEM:
+			case EAGAIN:
+				return true;
+			default:
+				return false;
+			}
+#endif
+		}
+
+		native_socket_t Native(std::intptr_t handle)
+		{
+			return static_cast<native_socket_t>(handle);
+		}
+
+#ifdef MSG_NOSIGNAL
+		const int send_flags = MSG_NOSIGNAL;	// a closed peer should fail the write, not raise SIGPIPE
+#else
+		const int send_flags = 0;
+#endif
+
+		void SetNoDelay(native_socket_t handle)
+		{
+			int enable = 1;
+			setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+		}
+	}
+
+	Socket::Socket(Handle_t handle)
+		: handle_(handle)
+	{
+	}
+
+	Socket::~Socket()
+	{
+		Close();
+	}
+
+	Socket::Socket(Socket&& other) noexcept
+		: handle_(std::exchange(other.handle_, -1))
+		, read_buffer_(std::move(other.read_buffer_))
+	{
+	}
+
+	Socket& Socket::operator=(Socket&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			handle_ = std::exchange(other.handle_, -1);
+			read_buffer_ = std::move(other.read_buffer_);
+		}
+		return *this;
+	}
+
+	void Socket::Close()
+	{
+		if (IsValid())
+			CloseNative(Native(handle_));
+		handle_ = -1;
+	}
+
+	bool Socket::IsValid() const
+	{
+		return handle_ != -1;
+	}
+
+	Socket Socket::Listen(std::uint16_t port)
+	{
+		EnsureStarted();
+
+		const auto handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		auto listener = Socket(static_cast<Handle_t>(handle));
+		if (!listener.IsValid())
+			throw(std::runtime_error("Could not create socket!"));
+
+		int reuse = 1;
+		setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(port);
+
+		if (bind(handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(handle, SOMAXCONN) != 0)
+			throw(std::runtime_error("Could not listen on port " + std::to_string(port) + "!"));
+
+		return listener;
+	}
+
+	Socket Socket::Connect(const std::string& host, std::uint16_t port)
+	{
+		EnsureStarted();
+
+		addrinfo hints = {};
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_STREAM;
+
+		addrinfo* addresses = nullptr;
+		if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+			throw(std::runtime_error("Could not resolve " + host + "!"));
+
+		auto connection = Socket{};
+		for (auto address = addresses; address != nullptr && !connection.IsValid(); address = address->ai_next)
+		{
+			const auto handle = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+			auto candidate = Socket(static_cast<Handle_t>(handle));
+			if (candidate.IsValid() && connect(handle, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0)
+				connection = std::move(candidate);
+		}
+		freeaddrinfo(addresses);
+
+		if (!connection.IsValid())
+			throw(std::runtime_error("Could not connect to " + host + ":" + std::to_string(port) + "!"));
+
+		SetNoDelay(Native(connection.handle_));
+		return connection;
+	}
+
+	Socket Socket::Accept(bool& may_retry)
+	{
+		const auto handle = accept(Native(handle_), nullptr, nullptr);
+		auto connection = Socket(static_cast<Handle_t>(handle));
+		may_retry = connection.IsValid() || AcceptMayRecover();
+		if (connection.IsValid())
+			SetNoDelay(handle);
+		return connection;
+	}
+
+	bool Socket::ReadLine(std::string& line)
+	{
+		for (;;)
+		{
+			const auto newline = read_buffer_.find('\n');
+			if (newline != std::string::npos)
+			{
+				line.assign(read_buffer_, 0, newline);
+				read_buffer_.erase(0, newline + 1);
+				return true;
+			}
+
+			char chunk[4096];
+			const auto received = recv(Native(handle_), chunk, sizeof(chunk), 0);
+			if (received <= 0)
+				return false;
+
+			read_buffer_.append(chunk, static_cast<std::size_t>(received));
+		}
+	}
+
+	bool Socket::Write(const std::string& data)
+	{
+		std::size_t written = 0;
+		while (written < data.size())
+		{
+			const auto sent = send(Native(handle_), data.data() + written, static_cast<int>(data.size() - written), send_flags);
+			if (sent <= 0)
+				return false;
+
+			written += static_cast<std::size_t>(sent);
+		}
+		return true;
+	}
+
+	void Socket::Shutdown()
+	{
+		if (IsValid())
+			shutdown(Native(handle_), shutdown_both);
+	}
+
+	std::uint16_t Socket::LocalPort() const
+	{
+		sockaddr_in address = {};
+		socklen_t length = sizeof(address);
+		getsockname(Native(handle_), reinterpret_cast<sockaddr*>(&address), &length);
+		return ntohs(address.sin_port);
+	}
+}
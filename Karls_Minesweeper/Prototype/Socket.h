@@ -0,0 +1,54 @@
+#pragma once
+#ifndef SOCKET_H_
+#define SOCKET_H_
+
+#include <cstdint>
+#include <string>
+
+namespace kms
+{
+	// Blocking TCP socket over Winsock or BSD sockets, reading is line buffered.
+	// Failures to set up a connection throw std::runtime_error.
+	class Socket
+	{
+	public:
+		Socket() = default;
+		~Socket();
+
+		Socket(Socket&& other) noexcept;
+		Socket& operator=(Socket&& other) noexcept;
+		Socket(const Socket&) = delete;
+		Socket& operator=(const Socket&) = delete;
+
+		// Listen on the loopback interface, port 0 picks a free port
+		static Socket Listen(std::uint16_t port);
+		static Socket Connect(const std::string& host, std::uint16_t port);
+
+		// Returns an invalid socket when accept fails. may_retry tells whether a later Accept can still succeed, it is true
+		// for passing failures such as running out of descriptors or a client giving up while queued, and false once the
+		// listening socket has been shut down.
+		Socket Accept(bool& may_retry);
+
+		// Read up to the next '\n' (not included), returns false when the connection is closed
+		bool ReadLine(std::string& line);
+
+		// Write all of data, returns false if the connection is gone
+		bool Write(const std::string& data);
+
+		// Wake up any thread blocked in Accept or ReadLine on this socket
+		void Shutdown();
+
+		bool IsValid() const;
+		std::uint16_t LocalPort() const;
+
+	private:
+		using Handle_t = std::intptr_t;
+		explicit Socket(Handle_t handle);
+		void Close();
+
+		Handle_t handle_ = -1;
+		std::string read_buffer_;
+	};
+}
+
+#endif // !SOCKET_H_
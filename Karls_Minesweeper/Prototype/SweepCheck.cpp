@@ -0,0 +1,327 @@
+
+#include "SweepCheck.h"
+#include "ScanlineSweep.h"
+#include "SweepStats.h"
+#include "Topology.h"
+#include <exception>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace kms
+{
+	namespace
+	{
+		std::string Describe(const Size2D& board_size, unsigned coverage, Seed_t seed, const Pos2D& click, const std::string& what)
+		{
+			std::ostringstream out;
+			out << board_size.width << 'x' << board_size.height << " coverage " << coverage << " seed " << seed
+				<< " click " << click.x << ',' << click.y << ": " << what;
+			return out.str();
+		}
+
+		// Neighbours listed from the board geometry, written apart from the topologies of Topology.h so the check does not share
+		// their edge handling. Neighbours(board_size, position, fn) calls fn(Pos2D) for every distinct neighbour.
+		struct SquareReference
+		{
+			template<class T_Fn>
+			static void Neighbours(const Size2D& board_size, const Pos2D& position, T_Fn&& fn)
+			{
+				for (auto ny = position.y > 0 ? position.y - 1 : position.y; ny <= position.y + 1 && ny < board_size.height; ++ny)
+					for (auto nx = position.x > 0 ? position.x - 1 : position.x; nx <= position.x + 1 && nx < board_size.width; ++nx)
+						if (nx != position.x || ny != position.y)
+							fn(Position2D(nx, ny));
+			}
+		};
+
+		// every step of the 3x3 square, wrapped around both edges
+		struct TorusReference
+		{
+			template<class T_Fn>
+			static void Neighbours(const Size2D& board_size, const Pos2D& position, T_Fn&& fn)
+			{
+				for (auto dy = -1; dy <= 1; ++dy)
+				{
+					for (auto dx = -1; dx <= 1; ++dx)
+					{
+						if (dx != 0 || dy != 0)
+							fn(Position2D((position.x + board_size.width + dx) % board_size.width, (position.y + board_size.height + dy) % board_size.height));
+					}
+				}
+			}
+		};
+
+		// odd-r offset steps, odd rows are shifted half a tile right
+		struct HexReference
+		{
+			template<class T_Fn>
+			static void Neighbours(const Size2D& board_size, const Pos2D& position, T_Fn&& fn)
+			{
+				static const int even_steps[6][2] = { { -1, 0 }, { 1, 0 }, { -1, -1 }, { 0, -1 }, { -1, 1 }, { 0, 1 } };
+				static const int odd_steps[6][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 1, -1 }, { 0, 1 }, { 1, 1 } };
+
+				for (const auto& step : position.y % 2 == 0 ? even_steps : odd_steps)
+				{
+					const auto nx = static_cast<int>(position.x) + step[0];
+					const auto ny = static_cast<int>(position.y) + step[1];
+					if (nx >= 0 && ny >= 0 && nx < static_cast<int>(board_size.width) && ny < static_cast<int>(board_size.height))
+						fn(Position2D(static_cast<unsigned>(nx), static_cast<unsigned>(ny)));
+				}
+			}
+		};
+
+		// Tiles counted from IsMineAt directly, so the check does not share its numbers with PlaceMines
+		template<class T_Reference>
+		TilesVector_t ReferenceTiles(const Size2D& board_size, unsigned coverage, Seed_t seed)
+		{
+			TilesVector_t tiles(Size(board_size), 0);
+			for (auto y = 0u; y < board_size.height; ++y)
+			{
+				for (auto x = 0u; x < board_size.width; ++x)
+				{
+					auto& tile = tiles[y * board_size.width + x];
+					if (IsMineAt(seed, coverage, Position2D(x, y)))
+					{
+						tile = mine_value;
+						continue;
+					}
+
+					T_Reference::Neighbours(board_size, Position2D(x, y), [&](const Pos2D& neighbour) { tile += IsMineAt(seed, coverage, neighbour) ? 1 : 0; });
+				}
+			}
+			return tiles;
+		}
+
+		// Depth first flood over the neighbours, the click itself is always cleared and only blank tiles spread
+		template<class T_Reference>
+		void ReferenceFlood(const Size2D& board_size, const TilesVector_t& tiles, const Pos2D& click, std::vector<std::uint8_t>& cleared)
+		{
+			auto pending = std::vector<Pos2D>{ click };
+			while (!pending.empty())
+			{
+				const auto position = pending.back();
+				pending.pop_back();
+
+				const auto offset = position.y * board_size.width + position.x;
+				if (cleared[offset])
+					continue;
+
+				cleared[offset] = 1;
+				if (tiles[offset] != 0)
+					continue;
+
+				T_Reference::Neighbours(board_size, position, [&](const Pos2D& neighbour) { pending.push_back(neighbour); });
+			}
+		}
+
+		// PlaceMinesOn and TopologySweep of one topology against its reference, clicked like CheckSweep
+		template<class T_Topology, class T_Reference>
+		std::string CheckTopology(const Size2D& board_size, unsigned coverage, Seed_t seed, const std::vector<Pos2D>& clicks)
+		{
+			const auto tiles = ReferenceTiles<T_Reference>(board_size, coverage, seed);
+			auto expected = std::vector<std::uint8_t>(tiles.size(), 0);
+			auto swept = std::vector<std::uint8_t>(tiles.size(), 0);
+
+			try
+			{
+				if (PlaceMinesOn<T_Topology>(board_size, coverage, seed) != tiles)
+					return Describe(board_size, coverage, seed, clicks.front(), "PlaceMinesOn differs from the mines counted around every tile");
+
+				for (const auto& click : clicks)
+				{
+					ReferenceFlood<T_Reference>(board_size, tiles, click, expected);
+
+					TopologySweep<T_Topology>(board_size, click,
+						[&](Pos2D position) { return tiles[GetOffsetIndex(board_size, position)]; },
+						[&](Pos2D position)
+						{
+							auto& tile = swept[GetOffsetIndex(board_size, position)];
+							if (tile)
+								return false;
+
+							tile = 1;
+							return true;
+						});
+
+					if (swept != expected)
+						return Describe(board_size, coverage, seed, click, "TopologySweep cleared tiles differ from the flood fill");
+				}
+			}
+			catch (const std::exception& exception)
+			{
+				return Describe(board_size, coverage, seed, clicks.front(), std::string("threw ") + exception.what());
+			}
+
+			return {};
+		}
+	}
+
+	std::string CheckSweep(const Size2D& board_size, unsigned coverage, Seed_t seed, const std::vector<Pos2D>& clicks)
+	{
+		const auto tiles = ReferenceTiles<SquareReference>(board_size, coverage, seed);
+		auto expected = std::vector<std::uint8_t>(tiles.size(), 0);
+		auto swept = std::vector<std::uint8_t>(tiles.size(), 0);
+		SweepWorkspace workspace;
+
+		for (const auto& click : clicks)
+		{
+			ReferenceFlood<SquareReference>(board_size, tiles, click, expected);
+
+			auto swept_cleared = 0u;
+			try
+			{
+				ScanlineSweep(board_size, click,
+					[&](Pos2D position) { return tiles[GetOffsetIndex(board_size, position)]; },
+					[&](Pos2D position)
+					{
+						auto& tile = swept[GetOffsetIndex(board_size, position)];
+						if (tile)
+							return false;
+
+						tile = 1;
+						++swept_cleared;
+						return true;
+					},
+					workspace);
+			}
+			catch (const std::exception& exception)
+			{
+				return Describe(board_size, coverage, seed, click, std::string("threw ") + exception.what());
+			}
+
+			if (swept != expected)
+				return Describe(board_size, coverage, seed, click, "cleared tiles differ from the flood fill");
+
+#ifdef KMS_SWEEP_STATS
+			const auto& stats = LastSweepStats();
+			if (stats.tiles_cleared != swept_cleared)
+				return Describe(board_size, coverage, seed, click, "tiles_cleared does not match the cleared tiles");
+
+			if (stats.scanlines_swept > 4 * swept_cleared + 1)
+				return Describe(board_size, coverage, seed, click, "swept " + std::to_string(stats.scanlines_swept) + " scanlines for " + std::to_string(swept_cleared) + " tiles");
+#endif
+		}
+
+		return {};
+	}
+
+	bool RunSweepChecks(std::ostream& out, unsigned random_cases)
+	{
+		auto cases = 0u;
+		auto failures = 0u;
+		auto check = [&](const Size2D& board_size, unsigned coverage, Seed_t seed, const std::vector<Pos2D>& clicks)
+		{
+			++cases;
+			const auto failure = CheckSweep(board_size, coverage, seed, clicks);
+			if (failure.empty())
+				return;
+
+			if (++failures <= 10)
+				out << "FAIL " << failure << '\n';
+		};
+
+		// single rows and columns, clicked on every tile
+		for (auto length = 1u; length <= 64; ++length)
+		{
+			for (auto coverage : { 0u, 10u, 30u, 100u })
+			{
+				auto row_clicks = std::vector<Pos2D>{};
+				auto column_clicks = std::vector<Pos2D>{};
+				for (auto i = 0u; i < length; ++i)
+				{
+					row_clicks.push_back(Position2D(i, 0));
+					column_clicks.push_back(Position2D(0, i));
+				}
+
+				check(Size2D{ length, 1 }, coverage, length, row_clicks);
+				check(Size2D{ 1, length }, coverage, length, column_clicks);
+			}
+		}
+
+		// random boards, densities and clicks, including rows and columns again
+		std::mt19937_64 random(0x5EED);
+		for (auto i = 0u; i < random_cases; ++i)
+		{
+			auto board_size = Size2D{ 1 + static_cast<unsigned>(random() % 48), 1 + static_cast<unsigned>(random() % 48) };
+			if (i % 7 == 0)
+				board_size.width = 1;
+			else if (i % 11 == 0)
+				board_size.height = 1;
+
+			const auto coverage = static_cast<unsigned>(random() % 101);
+			const auto seed = static_cast<Seed_t>(random());
+
+			auto clicks = std::vector<Pos2D>(1 + random() % 4);
+			for (auto& click : clicks)
+				click = Position2D(static_cast<unsigned>(random() % board_size.width), static_cast<unsigned>(random() % board_size.height));
+
+			check(board_size, coverage, seed, clicks);
+		}
+
+		out << "Sweep checks: " << cases - failures << " of " << cases << " passed";
+#ifndef KMS_SWEEP_STATS
+		out << " (scanline bound not checked, build with KMS_SWEEP_STATS)";
+#endif
+		out << '\n';
+
+		return failures == 0;
+	}
+
+	std::string CheckTorusSweep(const Size2D& board_size, unsigned coverage, Seed_t seed, const std::vector<Pos2D>& clicks)
+	{
+		return CheckTopology<TorusTopology, TorusReference>(board_size, coverage, seed, clicks);
+	}
+
+	std::string CheckHexSweep(const Size2D& board_size, unsigned coverage, Seed_t seed, const std::vector<Pos2D>& clicks)
+	{
+		return CheckTopology<HexTopology, HexReference>(board_size, coverage, seed, clicks);
+	}
+
+	bool RunTopologyChecks(std::ostream& out, unsigned random_cases)
+	{
+		auto cases = 0u;
+		auto failures = 0u;
+		auto report = [&](const std::string& failure)
+		{
+			++cases;
+			if (!failure.empty() && ++failures <= 10)
+				out << "FAIL " << failure << '\n';
+		};
+
+		// a torus under 3x3 would make a tile its own neighbour
+		++cases;
+		try
+		{
+			PlaceMinesOn<TorusTopology>(Size2D{ 2, 8 }, 10, 1);
+			if (++failures <= 10)
+				out << "FAIL 2x8 torus was generated\n";
+		}
+		catch (const std::domain_error&)
+		{
+		}
+
+		std::mt19937_64 random(0x7095);
+		for (auto i = 0u; i < random_cases; ++i)
+		{
+			const auto hex = i % 2 != 0;
+			const auto least = hex ? 1u : 3u;
+			auto board_size = Size2D{ least + static_cast<unsigned>(random() % 40), least + static_cast<unsigned>(random() % 40) };
+			if (i % 7 == 0)
+				board_size.width = least;
+			else if (i % 11 == 0)
+				board_size.height = least;
+
+			const auto coverage = static_cast<unsigned>(random() % 51);
+			const auto seed = static_cast<Seed_t>(random());
+
+			auto clicks = std::vector<Pos2D>(1 + random() % 4);
+			for (auto& click : clicks)
+				click = Position2D(static_cast<unsigned>(random() % board_size.width), static_cast<unsigned>(random() % board_size.height));
+
+			report(hex ? CheckHexSweep(board_size, coverage, seed, clicks) : CheckTorusSweep(board_size, coverage, seed, clicks));
+		}
+
+		out << "Torus and hex checks: " << cases - failures << " of " << cases << " passed\n";
+		return failures == 0;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef SWEEPCHECK_H_
+#define SWEEPCHECK_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Minesweep_Basics.h"
+#include "MineField.h"
+
+namespace kms
+{
+	// Sweep a board generated from seed and coverage at every click in turn, sharing the cleared tiles between the clicks,
+	// and compare each sweep with a plain 8-connected flood fill. Returns the first difference found, empty if there is none.
+	// Built with KMS_SWEEP_STATS it also checks that no sweep visited more than 4 * cleared + 1 scanlines.
+	std::string CheckSweep(const Size2D& board_size, unsigned coverage, Seed_t seed, const std::vector<Pos2D>& clicks);
+
+	// Run CheckSweep on single rows, single columns and random boards, densities and clicks, print a summary and return
+	// whether every case passed
+	bool RunSweepChecks(std::ostream& out, unsigned random_cases = 20000);
+
+	// Generate a torus or hex board with PlaceMinesOn and compare it with mines counted around every tile, then sweep it
+	// with TopologySweep at every click in turn like CheckSweep, against a flood fill over that topology's neighbours.
+	// Returns the first difference found, empty if there is none.
+	std::string CheckTorusSweep(const Size2D& board_size, unsigned coverage, Seed_t seed, const std::vector<Pos2D>& clicks);
+	std::string CheckHexSweep(const Size2D& board_size, unsigned coverage, Seed_t seed, const std::vector<Pos2D>& clicks);
+
+	// Run CheckTorusSweep and CheckHexSweep on random boards, densities and clicks, including the narrowest boards each
+	// topology allows, print a summary and return whether every case passed
+	bool RunTopologyChecks(std::ostream& out, unsigned random_cases = 4000);
+}
+
+#endif // !SWEEPCHECK_H_
@@ -0,0 +1,83 @@
+
+#include "SweepStats.h"
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace kms
+{
+	namespace
+	{
+		thread_local SweepStats current_sweep_stats;
+
+		std::mutex trace_mutex;
+		std::ostream* trace_stream = nullptr;
+		bool trace_started = false;
+		const auto trace_epoch = std::chrono::steady_clock::now();
+
+#ifdef KMS_SWEEP_TRACE
+		void WriteTraceEvent(const Pos2D& start_position, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+		{
+			using microseconds = std::chrono::duration<double, std::micro>;
+			const auto& stats = current_sweep_stats;
+
+			// format outside the lock, only the write is serialized
+			std::ostringstream event;
+			event << "{\"name\":\"ScanlineSweep\",\"cat\":\"sweep\",\"ph\":\"X\""
+				<< ",\"ts\":" << microseconds(begin - trace_epoch).count()
+				<< ",\"dur\":" << microseconds(end - begin).count()
+				<< ",\"pid\":0,\"tid\":" << std::hash<std::thread::id>{}(std::this_thread::get_id())
+				<< ",\"args\":{\"x\":" << start_position.x << ",\"y\":" << start_position.y
+				<< ",\"scanlines_swept\":" << stats.scanlines_swept
+				<< ",\"scanlines_cached\":" << stats.scanlines_cached
+				<< ",\"scanlines_aborted\":" << stats.scanlines_aborted
+				<< ",\"start_extended\":" << stats.start_extended
+				<< ",\"magnitude_extended\":" << stats.magnitude_extended
+				<< ",\"tiles_cleared\":" << stats.tiles_cleared
+				<< ",\"max_stack_depth\":" << stats.max_stack_depth
+				<< "}}";
+
+			std::lock_guard<std::mutex> lock(trace_mutex);
+			if (trace_stream == nullptr)
+				return;
+
+			*trace_stream << (trace_started ? ",\n" : "[\n") << event.str();
+			trace_started = true;
+		}
+#endif
+	}
+
+	const SweepStats& LastSweepStats()
+	{
+		return current_sweep_stats;
+	}
+
+	void SetSweepTraceStream(std::ostream* stream)
+	{
+		std::lock_guard<std::mutex> lock(trace_mutex);
+		trace_stream = stream;
+		trace_started = false;
+	}
+
+	namespace detail
+	{
+		SweepStats& CurrentSweepStats()
+		{
+			return current_sweep_stats;
+		}
+
+		SweepStatsScope::SweepStatsScope(const Pos2D& start_position)
+			: start_position_(start_position)
+			, begin_(std::chrono::steady_clock::now())
+		{
+			current_sweep_stats = SweepStats{};
+		}
+
+		SweepStatsScope::~SweepStatsScope()
+		{
+#ifdef KMS_SWEEP_TRACE
+			WriteTraceEvent(start_position_, begin_, std::chrono::steady_clock::now());
+#endif
+		}
+	}
+}
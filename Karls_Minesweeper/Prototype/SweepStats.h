@@ -0,0 +1,63 @@
+#pragma once
+#ifndef SWEEPSTATS_H_
+#define SWEEPSTATS_H_
+
+#include <chrono>
+#include <ostream>
+#include "Minesweep_Basics.h"
+
+// Define KMS_SWEEP_STATS to have ScanlineSweep count what it does on every sweep,
+// define KMS_SWEEP_TRACE to also write every sweep as a chrome trace event (chrome://tracing, perfetto).
+// With neither defined the counting statements compile away.
+#if defined(KMS_SWEEP_TRACE) && !defined(KMS_SWEEP_STATS)
+#define KMS_SWEEP_STATS
+#endif
+
+#ifdef KMS_SWEEP_STATS
+#define KMS_SWEEP_STAT(statement) statement
+#else
+#define KMS_SWEEP_STAT(statement)
+#endif
+
+namespace kms
+{
+	struct SweepStats
+	{
+		unsigned scanlines_swept = 0;
+		unsigned scanlines_cached = 0;
+		unsigned scanlines_aborted = 0;		// scanlines where fn_clear_tile reported an already cleared tile
+		unsigned start_extended = 0;
+		unsigned magnitude_extended = 0;
+		unsigned tiles_cleared = 0;
+		unsigned max_stack_depth = 0;		// most scanlines waiting to be swept at once
+	};
+
+	// Counters of the last ScanlineSweep on the calling thread, always zero unless built with KMS_SWEEP_STATS
+	const SweepStats& LastSweepStats();
+
+	// Stream that receives the trace events, nullptr (the default) stops tracing. Has no effect unless built with KMS_SWEEP_TRACE.
+	// The events are written in the JSON array format, the closing bracket is optional for the trace viewers.
+	void SetSweepTraceStream(std::ostream* stream);
+
+	namespace detail
+	{
+		SweepStats& CurrentSweepStats();
+
+		// Resets the counters of the calling thread when a sweep begins and writes the trace event when it ends
+		class SweepStatsScope
+		{
+		public:
+			explicit SweepStatsScope(const Pos2D& start_position);
+			~SweepStatsScope();
+
+			SweepStatsScope(const SweepStatsScope&) = delete;
+			SweepStatsScope& operator=(const SweepStatsScope&) = delete;
+
+		private:
+			Pos2D start_position_;
+			std::chrono::steady_clock::time_point begin_;
+		};
+	}
+}
+
+#endif // !SWEEPSTATS_H_
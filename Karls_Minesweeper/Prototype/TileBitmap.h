@@ -0,0 +1,61 @@
+#pragma once
+#ifndef TILEBITMAP_H_
+#define TILEBITMAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace kms
+{
+	// One bit per tile, indexed by the Offset of the board it belongs to
+	class TileBitmap
+	{
+	public:
+		using Word_t = std::uint64_t;
+		static constexpr unsigned word_bits = 64;
+
+		explicit TileBitmap(std::size_t size, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: words_((size + word_bits - 1) / word_bits, 0, resource)
+			, size_(size)
+		{
+		}
+
+		bool Test(std::size_t index) const { return (words_[index / word_bits] >> (index % word_bits)) & 1u; }
+		void Set(std::size_t index) { words_[index / word_bits] |= Bit(index); }
+		void Reset(std::size_t index) { words_[index / word_bits] &= ~Bit(index); }
+		void Flip(std::size_t index) { words_[index / word_bits] ^= Bit(index); }
+
+		// Set or reset the bits [begin, end) a word at a time
+		void Assign(std::size_t begin, std::size_t end, bool value)
+		{
+			while (begin < end)
+			{
+				const auto word_index = begin / word_bits;
+				const auto first_bit = begin % word_bits;
+				const auto bit_count = std::min<std::size_t>(word_bits - first_bit, end - begin);
+				const auto mask = (bit_count == word_bits ? ~Word_t{ 0 } : ((Word_t{ 1 } << bit_count) - 1)) << first_bit;
+
+				if (value)
+					words_[word_index] |= mask;
+				else
+					words_[word_index] &= ~mask;
+
+				begin += bit_count;
+			}
+		}
+
+		std::size_t Size() const { return size_; }
+		std::size_t MemoryUsage() const { return words_.capacity() * sizeof(Word_t); }
+		const std::pmr::vector<Word_t>& Words() const { return words_; }
+
+	private:
+		static Word_t Bit(std::size_t index) { return Word_t{ 1 } << (index % word_bits); }
+
+		std::pmr::vector<Word_t> words_;
+		std::size_t size_ = 0;
+	};
+}
+
+#endif // !TILEBITMAP_H_
@@ -0,0 +1,172 @@
+#pragma once
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+#include "Minesweep_Basics.h"
+#include "MineField.h"
+#include "ScanlineSweep.h"
+
+namespace kms
+{
+	// Topologies are policies with only static members. The generation and sweep kernels below are templated on them,
+	// so every instantiation holds exactly the edge handling of its own topology and nothing of the others.
+	// ForEachNeighbour(board_size, position, fn) calls fn(Pos2D) once for every distinct neighbour of position.
+
+	// Bounded square grid, the eight surrounding tiles that are on the board
+	struct SquareTopology
+	{
+		static constexpr unsigned max_neighbours = 8;
+
+		static void Validate(const Size2D&) {}
+
+		template<class T_Fn>
+		static void ForEachNeighbour(const Size2D& board_size, const Pos2D& position, T_Fn&& fn)
+		{
+			const auto xbegin = position.x > 0 ? position.x - 1 : 0u;
+			const auto ybegin = position.y > 0 ? position.y - 1 : 0u;
+			const auto xend = position.x + 1 < board_size.width ? position.x + 2 : board_size.width;
+			const auto yend = position.y + 1 < board_size.height ? position.y + 2 : board_size.height;
+
+			for (auto y = ybegin; y < yend; ++y)
+				for (auto x = xbegin; x < xend; ++x)
+					if (x != position.x || y != position.y)
+						fn(Position2D(x, y));
+		}
+	};
+
+	// Square grid whose left/right and top/bottom edges are joined, every tile has eight neighbours
+	struct TorusTopology
+	{
+		static constexpr unsigned max_neighbours = 8;
+
+		// with fewer than three rows or columns a tile would be its own neighbour, or the same neighbour twice
+		static void Validate(const Size2D& board_size)
+		{
+			if (board_size.width < 3 || board_size.height < 3)
+				throw(std::domain_error("A torus board needs at least 3x3 tiles!"));
+		}
+
+		template<class T_Fn>
+		static void ForEachNeighbour(const Size2D& board_size, const Pos2D& position, T_Fn&& fn)
+		{
+			const auto left = position.x > 0 ? position.x - 1 : board_size.width - 1;
+			const auto right = position.x + 1 < board_size.width ? position.x + 1 : 0u;
+			const auto up = position.y > 0 ? position.y - 1 : board_size.height - 1;
+			const auto down = position.y + 1 < board_size.height ? position.y + 1 : 0u;
+
+			fn(Position2D(left, up));
+			fn(Position2D(position.x, up));
+			fn(Position2D(right, up));
+			fn(Position2D(left, position.y));
+			fn(Position2D(right, position.y));
+			fn(Position2D(left, down));
+			fn(Position2D(position.x, down));
+			fn(Position2D(right, down));
+		}
+	};
+
+	// Hexagonal tiles in "odd-r" offset layout, every odd row is shifted half a tile to the right, six neighbours
+	struct HexTopology
+	{
+		static constexpr unsigned max_neighbours = 6;
+
+		static void Validate(const Size2D&) {}
+
+		template<class T_Fn>
+		static void ForEachNeighbour(const Size2D& board_size, const Pos2D& position, T_Fn&& fn)
+		{
+			if (position.x > 0)
+				fn(Position2D(position.x - 1, position.y));
+			if (position.x + 1 < board_size.width)
+				fn(Position2D(position.x + 1, position.y));
+
+			// the two tiles above and below lie left of x on even rows and right of x on odd rows
+			const auto xleft = position.y % 2 == 0 ? static_cast<int>(position.x) - 1 : static_cast<int>(position.x);
+			for (auto x = xleft; x < xleft + 2; ++x)
+			{
+				if (x < 0 || static_cast<unsigned>(x) >= board_size.width)
+					continue;
+
+				if (position.y > 0)
+					fn(Position2D(static_cast<unsigned>(x), position.y - 1));
+				if (position.y + 1 < board_size.height)
+					fn(Position2D(static_cast<unsigned>(x), position.y + 1));
+			}
+		}
+	};
+
+	// PlaceMines for any topology, mines are decided by the same hash so a mine is at the same position in every topology
+	template<class T_Topology>
+	TilesVector_t PlaceMinesOn(const Size2D& board_size, unsigned coverage, Seed_t seed)
+	{
+		T_Topology::Validate(board_size);
+
+		auto mines = std::vector<std::uint8_t>(Size(board_size));
+		for (auto y = 0u; y < board_size.height; ++y)
+			for (auto x = 0u; x < board_size.width; ++x)
+				mines[y * board_size.width + x] = IsMineAt(seed, coverage, Position2D(x, y));
+
+		TilesVector_t tiles(Size(board_size), 0);
+		for (auto y = 0u; y < board_size.height; ++y)
+		{
+			for (auto x = 0u; x < board_size.width; ++x)
+			{
+				const auto offset = y * board_size.width + x;
+				if (mines[offset])
+				{
+					tiles[offset] = mine_value;
+					continue;
+				}
+
+				Tile_t count = 0;
+				T_Topology::ForEachNeighbour(board_size, Position2D(x, y), [&](const Pos2D& neighbour) { count += mines[neighbour.y * board_size.width + neighbour.x]; });
+				tiles[offset] = count;
+			}
+		}
+
+		return tiles;
+	}
+
+	// The square grid keeps its scatter based generator
+	template<>
+	inline TilesVector_t PlaceMinesOn<SquareTopology>(const Size2D& board_size, unsigned coverage, Seed_t seed)
+	{
+		return PlaceMines(board_size, coverage, seed);
+	}
+
+	// ScanlineSweep for any topology: clear the start tile and, while cleared tiles are blank, clear their neighbours
+	template<class T_Topology>
+	void TopologySweep(const Size2D& board_size, const Pos2D& start_position, std::function<int(Pos2D)> fn_get_tile_data, std::function<bool(Pos2D)> fn_clear_tile)
+	{
+		if (start_position.x >= board_size.width || start_position.y >= board_size.height)
+			throw(std::out_of_range("Not on board!"));
+
+		if (!fn_clear_tile(start_position) || fn_get_tile_data(start_position) != 0)
+			return;
+
+		auto unhandled_tiles = std::vector<Pos2D>{ start_position };
+		while (!unhandled_tiles.empty())
+		{
+			const auto position = unhandled_tiles.back();
+			unhandled_tiles.pop_back();
+
+			T_Topology::ForEachNeighbour(board_size, position, [&](const Pos2D& neighbour) {
+				if (fn_clear_tile(neighbour) && fn_get_tile_data(neighbour) == 0)
+					unhandled_tiles.push_back(neighbour);
+			});
+		}
+	}
+
+	// The square grid keeps its scanline sweep
+	template<>
+	inline void TopologySweep<SquareTopology>(const Size2D& board_size, const Pos2D& start_position, std::function<int(Pos2D)> fn_get_tile_data, std::function<bool(Pos2D)> fn_clear_tile)
+	{
+		ScanlineSweep(board_size, start_position, fn_get_tile_data, fn_clear_tile);
+	}
+}
+
+#endif // !TOPOLOGY_H_